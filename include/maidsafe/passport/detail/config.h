@@ -63,6 +63,27 @@ struct SignerFob<MpidTag> {
   using Tag = AnmpidTag;
 };
 
+// The size, in bits, of the keys generated for fobs of type 'TagType'.  The anonymous fobs (Anmaid,
+// Anpmid and Anmpid) only ever sign their one key, while Maid, Pmid and Mpid sign on every request,
+// so specialising this allows signing throughput to be traded against security margin for each
+// identity type.  Any specialisation must be visible wherever the fob type is used, i.e. belongs
+// in this file.
+const unsigned kDefaultKeyBits = 2048;
+
+template <typename TagType>
+struct KeySize {
+  static const unsigned kBits = kDefaultKeyBits;
+};
+
+struct RsaPssPolicy;
+
+// The signature scheme used by fobs of type 'TagType' (see signature_policy.h).  A public fob uses
+// the same scheme as its private counterpart.
+template <typename TagType>
+struct SignaturePolicy {
+  using type = RsaPssPolicy;
+};
+
 #ifdef TESTING
 
 template <typename NameType>
@@ -19,6 +19,7 @@
 #ifndef MAIDSAFE_PASSPORT_DETAIL_FOB_H_
 #define MAIDSAFE_PASSPORT_DETAIL_FOB_H_
 
+#include <memory>
 #include <type_traits>
 #include <string>
 #include <vector>
@@ -30,7 +31,9 @@
 #include "maidsafe/common/types.h"
 #include "maidsafe/common/serialisation/serialisation.h"
 
+#include "maidsafe/passport/metrics.h"
 #include "maidsafe/passport/detail/config.h"
+#include "maidsafe/passport/detail/signature_policy.h"
 
 namespace maidsafe {
 
@@ -43,41 +46,72 @@ struct is_self_signed {
   using type = typename std::is_same<typename SignerFob<TagType>::Tag, TagType>::type;
 };
 
-asymm::PlainText GetRandomString();
+// The bytes identifying 'TagType' which are appended to a fob's encoded public key when it is signed
+// or validated.  These are the serialised form of 'TagType::kValue', and so depend on the
+// serialisation library's encoding; they are computed once on first use rather than being hard-coded.
+template <typename TagType>
+const std::string& TagSuffix() {
+  static const std::string suffix(ConvertToString(TagType::kValue));
+  return suffix;
+}
+
+// Generates a new key pair of 'KeySize<TagType>::kBits' for a fob of type 'TagType', recording it
+// in the library's metrics.
+template <typename TagType>
+typename SignaturePolicy<TagType>::type::Keys GenerateFobKeys() {
+  using Policy = typename SignaturePolicy<TagType>::type;
+  static_assert(KeySize<TagType>::kBits >= Policy::kMinimumKeyBits,
+                "The key size is too small for this fob type's signature policy.");
+  ScopedTimer timer(Operation::kKeyGeneration, TagType::kValue);
+  return Policy::GenerateKeyPair(KeySize<TagType>::kBits);
+}
+
+// Returns 'keys' if they are the size 'KeySize<TagType>::kBits', otherwise throws.  Used by the Fob
+// constructors which take a previously-generated key pair.
+template <typename TagType>
+typename SignaturePolicy<TagType>::type::Keys CheckFobKeySize(
+    typename SignaturePolicy<TagType>::type::Keys keys) {
+  if (SignaturePolicy<TagType>::type::KeyBits(keys.public_key) != KeySize<TagType>::kBits)
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+  return keys;
+}
 
 
 
 // ========== Self-signed Fob ======================================================================
+// Copies of a fob share one immutable block of key material, so the references returned by its
+// accessors remain valid until the fob is destroyed or assigned to.  The public key is encoded once
+// on construction; the encoding is then reused for naming, signing, validating and serialising the
+// fob.
 template <typename TagType>
 class Fob<TagType, typename std::enable_if<is_self_signed<TagType>::type::value>::type> {
  public:
   using Name = maidsafe::detail::Name<Fob>;
   using Signer = Fob<typename SignerFob<TagType>::Tag>;
   using Tag = TagType;
-  using ValidationToken = asymm::Signature;
+  using Policy = typename SignaturePolicy<TagType>::type;
+  using Keys = typename Policy::Keys;
+  using ValidationToken = typename Policy::Signature;
 
   // This constructor is only available to this specialisation (i.e. self-signed fob).
-  Fob()
-      : keys_(asymm::GenerateKeyPair()),
-        validation_token_(CreateValidationToken()),
-        name_(CreateName()) {
+  Fob() : data_(MakeData(GenerateFobKeys<Tag>())) {
     static_assert(std::is_same<Fob<Tag>, Signer>::value,
                   "This constructor is only applicable for self-signing fobs.");
   }
 
-  Fob(const Fob& other)
-      : keys_(other.keys_), validation_token_(other.validation_token_), name_(other.name_) {}
+  // Constructs using a previously-generated key pair (e.g. one taken from a KeyPool).
+  // Throws if 'keys' aren't of the size given by KeySize for this fob type.
+  explicit Fob(Keys keys) : data_(MakeData(CheckFobKeySize<Tag>(std::move(keys)))) {}
 
-  Fob(Fob&& other)
-      : keys_(std::move(other.keys_)),
-        validation_token_(std::move(other.validation_token_)),
-        name_(std::move(other.name_)) {}
+  Fob(const Fob& other) : data_(other.data_) {}
+
+  // Moving shares the key material just as copying does, rather than leaving 'other' without any;
+  // there is no cheaper move for a shared immutable block, and a moved-from fob stays usable.
+  Fob(Fob&& other) : data_(other.data_) {}
 
   friend void swap(Fob& lhs, Fob& rhs) {
     using std::swap;
-    swap(lhs.keys_, rhs.keys_);
-    swap(lhs.validation_token_, rhs.validation_token_);
-    swap(lhs.name_, rhs.name_);
+    swap(lhs.data_, rhs.data_);
   }
 
   Fob& operator=(Fob other) {
@@ -87,68 +121,97 @@ class Fob<TagType, typename std::enable_if<is_self_signed<TagType>::type::value>
 
   Fob(const crypto::CipherText& encrypted_fob, const crypto::AES256Key& symm_key,
       const crypto::AES256InitialisationVector& symm_iv)
-      : keys_(), validation_token_(), name_() {
+      : data_() {
+    ScopedTimer timer(Operation::kFobDecrypt, Tag::kValue);
+    auto data(std::make_shared<Data>());
     try {
       std::string serialised_fob(crypto::SymmDecrypt(encrypted_fob, symm_key, symm_iv).string());
-      maidsafe::ConvertFromString(serialised_fob, keys_, validation_token_, name_);
+      maidsafe::ConvertFromString(serialised_fob, data->keys, data->validation_token, data->name);
+      data->encoded_public_key = Policy::EncodeKey(data->keys.public_key);
     } catch (const std::exception&) {
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
     }
-    ValidateToken();
+    ValidateToken(*data);
+    data_ = std::move(data);
   }
 
   crypto::CipherText Encrypt(const crypto::AES256Key& symm_key,
                              const crypto::AES256InitialisationVector& symm_iv) const {
-    crypto::PlainText serialised_fob(ConvertToString(keys_, validation_token_, name_));
+    ScopedTimer timer(Operation::kFobEncrypt, Tag::kValue);
+    crypto::PlainText serialised_fob(
+        ConvertToString(data_->keys, data_->validation_token, data_->name));
     return crypto::SymmEncrypt(serialised_fob, symm_key, symm_iv);
   }
 
-  Name name() const { return name_; }
-  ValidationToken validation_token() const { return validation_token_; }
-  asymm::PrivateKey private_key() const { return keys_.private_key; }
-  asymm::PublicKey public_key() const { return keys_.public_key; }
+  const Name& name() const { return data_->name; }
+  const ValidationToken& validation_token() const { return data_->validation_token; }
+  const typename Policy::PrivateKey& private_key() const { return data_->keys.private_key; }
+  const typename Policy::PublicKey& public_key() const { return data_->keys.public_key; }
+  const typename Policy::EncodedPublicKey& encoded_public_key() const {
+    return data_->encoded_public_key;
+  }
 
  private:
-  Identity CreateName() const {
-    return crypto::Hash<crypto::SHA512>(asymm::EncodeKey(keys_.public_key) + validation_token_);
+  struct Data {
+    Keys keys;
+    typename Policy::EncodedPublicKey encoded_public_key;
+    ValidationToken validation_token;
+    Name name;
+  };
+
+  static std::shared_ptr<const Data> MakeData(Keys keys) {
+    auto data(std::make_shared<Data>());
+    data->keys = std::move(keys);
+    data->encoded_public_key = Policy::EncodeKey(data->keys.public_key);
+    data->validation_token = CreateValidationToken(*data);
+    data->name = Name(CreateName(*data));
+    return data;
   }
 
-  ValidationToken CreateValidationToken() const {
-    return asymm::Sign(asymm::PlainText(asymm::EncodeKey(keys_.public_key).string() +
-                                        ConvertToString(Tag::kValue)),
-                       keys_.private_key);
+  static Identity CreateName(const Data& data) {
+    return crypto::Hash<crypto::SHA512>(data.encoded_public_key.string() +
+                                        Policy::SignatureBytes(data.validation_token));
   }
 
-  void ValidateToken() const {
+  static typename Policy::PlainText SignedData(const Data& data) {
+    return typename Policy::PlainText(data.encoded_public_key.string() + TagSuffix<Tag>());
+  }
+
+  static ValidationToken CreateValidationToken(const Data& data) {
+    ScopedTimer timer(Operation::kCreateValidationToken, Tag::kValue);
+    return Policy::Sign(SignedData(data), data.keys.private_key);
+  }
+
+  static void ValidateToken(const Data& data) {
+    ScopedTimer timer(Operation::kValidateToken, Tag::kValue);
     // Check the validation token is valid
-    if (!asymm::CheckSignature(asymm::PlainText(asymm::EncodeKey(keys_.public_key).string() +
-                                                ConvertToString(Tag::kValue)),
-                               validation_token_, keys_.public_key)) {
+    if (!Policy::CheckSignature(SignedData(data), data.validation_token, data.keys.public_key)) {
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
     }
     // Check the private key hasn't been replaced
-    asymm::PlainText plain(GetRandomString());
-    if (asymm::Decrypt(asymm::Encrypt(plain, keys_.public_key), keys_.private_key) != plain)
+    if (!Policy::KeysMatch(data.keys))
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
     // Check the name is the hash of the public key + validation token
-    if (CreateName() != name_.value)
+    if (CreateName(data) != data.name.value)
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
   }
 
-  asymm::Keys keys_;
-  ValidationToken validation_token_;
-  Name name_;
+  std::shared_ptr<const Data> data_;
 };
 
 
 
 // ========== Non-self-signed Fob ==================================================================
+// Shares its data between copies in the same way as the self-signed Fob above.
 template <typename TagType>
 class Fob<TagType, typename std::enable_if<!is_self_signed<TagType>::type::value>::type> {
  public:
   using Name = maidsafe::detail::Name<Fob>;
   using Signer = Fob<typename SignerFob<TagType>::Tag>;
   using Tag = TagType;
+  using Policy = typename SignaturePolicy<TagType>::type;
+  using SignerPolicy = typename SignaturePolicy<typename SignerFob<TagType>::Tag>::type;
+  using Keys = typename Policy::Keys;
 
   struct ValidationToken {
     ValidationToken() = default;
@@ -184,8 +247,8 @@ class Fob<TagType, typename std::enable_if<!is_self_signed<TagType>::type::value
       archive(signature_of_public_key, self_signature);
     }
 
-    asymm::Signature signature_of_public_key;
-    asymm::Signature self_signature;
+    typename SignerPolicy::Signature signature_of_public_key;
+    typename Policy::Signature self_signature;
   };
 
   Fob() = delete;
@@ -193,23 +256,21 @@ class Fob<TagType, typename std::enable_if<!is_self_signed<TagType>::type::value
   // This constructor is only available to this specialisation (i.e. non-self-signed fob)
   explicit Fob(const Signer& signing_fob,
                typename std::enable_if<!std::is_same<Fob<Tag>, Signer>::value>::type* = 0)
-      : keys_(asymm::GenerateKeyPair()),
-        validation_token_(CreateValidationToken(signing_fob.private_key())),
-        name_(CreateName()) {}
+      : data_(MakeData(GenerateFobKeys<Tag>(), signing_fob.private_key())) {}
 
-  Fob(const Fob& other)
-      : keys_(other.keys_), validation_token_(other.validation_token_), name_(other.name_) {}
+  // As above, but uses a previously-generated key pair (e.g. one taken from a KeyPool).
+  Fob(const Signer& signing_fob, Keys keys,
+      typename std::enable_if<!std::is_same<Fob<Tag>, Signer>::value>::type* = 0)
+      : data_(MakeData(CheckFobKeySize<Tag>(std::move(keys)), signing_fob.private_key())) {}
 
-  Fob(Fob&& other)
-      : keys_(std::move(other.keys_)),
-        validation_token_(std::move(other.validation_token_)),
-        name_(std::move(other.name_)) {}
+  Fob(const Fob& other) : data_(other.data_) {}
+
+  // As for the self-signed Fob, 'other' is left sharing the key material.
+  Fob(Fob&& other) : data_(other.data_) {}
 
   friend void swap(Fob& lhs, Fob& rhs) {
     using std::swap;
-    swap(lhs.keys_, rhs.keys_);
-    swap(lhs.validation_token_, rhs.validation_token_);
-    swap(lhs.name_, rhs.name_);
+    swap(lhs.data_, rhs.data_);
   }
 
   Fob& operator=(Fob other) {
@@ -219,65 +280,93 @@ class Fob<TagType, typename std::enable_if<!is_self_signed<TagType>::type::value
 
   Fob(const crypto::CipherText& encrypted_fob, const crypto::AES256Key& symm_key,
       const crypto::AES256InitialisationVector& symm_iv)
-      : keys_(), validation_token_(), name_() {
+      : data_() {
+    ScopedTimer timer(Operation::kFobDecrypt, Tag::kValue);
+    auto data(std::make_shared<Data>());
     try {
       std::string serialised_fob(crypto::SymmDecrypt(encrypted_fob, symm_key, symm_iv).string());
-      maidsafe::ConvertFromString(serialised_fob, keys_, validation_token_, name_);
+      maidsafe::ConvertFromString(serialised_fob, data->keys, data->validation_token, data->name);
+      data->encoded_public_key = Policy::EncodeKey(data->keys.public_key);
     } catch (const std::exception&) {
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
     }
-    ValidateToken();
+    ValidateToken(*data);
+    data_ = std::move(data);
   }
 
   crypto::CipherText Encrypt(const crypto::AES256Key& symm_key,
                              const crypto::AES256InitialisationVector& symm_iv) const {
-    crypto::PlainText serialised_fob(ConvertToString(keys_, validation_token_, name_));
+    ScopedTimer timer(Operation::kFobEncrypt, Tag::kValue);
+    crypto::PlainText serialised_fob(
+        ConvertToString(data_->keys, data_->validation_token, data_->name));
     return crypto::SymmEncrypt(serialised_fob, symm_key, symm_iv);
   }
 
-  Name name() const { return name_; }
-  ValidationToken validation_token() const { return validation_token_; }
-  asymm::PrivateKey private_key() const { return keys_.private_key; }
-  asymm::PublicKey public_key() const { return keys_.public_key; }
+  const Name& name() const { return data_->name; }
+  const ValidationToken& validation_token() const { return data_->validation_token; }
+  const typename Policy::PrivateKey& private_key() const { return data_->keys.private_key; }
+  const typename Policy::PublicKey& public_key() const { return data_->keys.public_key; }
+  const typename Policy::EncodedPublicKey& encoded_public_key() const {
+    return data_->encoded_public_key;
+  }
 
  private:
-  Identity CreateName() const {
-    return crypto::Hash<crypto::SHA512>(asymm::EncodeKey(keys_.public_key).string() +
-                                        ConvertToString(validation_token_));
+  struct Data {
+    Keys keys;
+    typename Policy::EncodedPublicKey encoded_public_key;
+    ValidationToken validation_token;
+    Name name;
+  };
+
+  static std::shared_ptr<const Data> MakeData(
+      Keys keys, const typename SignerPolicy::PrivateKey& signing_key) {
+    auto data(std::make_shared<Data>());
+    data->keys = std::move(keys);
+    data->encoded_public_key = Policy::EncodeKey(data->keys.public_key);
+    data->validation_token = CreateValidationToken(*data, signing_key);
+    data->name = Name(CreateName(*data));
+    return data;
   }
 
-  ValidationToken CreateValidationToken(const asymm::PrivateKey& signing_key) const {
+  static Identity CreateName(const Data& data) {
+    return crypto::Hash<crypto::SHA512>(data.encoded_public_key.string() +
+                                        ConvertToString(data.validation_token));
+  }
+
+  static typename Policy::PlainText SelfSignedData(
+      const typename SignerPolicy::Signature& signature_of_public_key, const Data& data) {
+    return typename Policy::PlainText(SignerPolicy::SignatureBytes(signature_of_public_key) +
+                                      data.encoded_public_key.string() + TagSuffix<Tag>());
+  }
+
+  static ValidationToken CreateValidationToken(
+      const Data& data, const typename SignerPolicy::PrivateKey& signing_key) {
+    ScopedTimer timer(Operation::kCreateValidationToken, Tag::kValue);
     ValidationToken token;
-    asymm::EncodedPublicKey serialised_public_key(asymm::EncodeKey(keys_.public_key));
     token.signature_of_public_key =
-        asymm::Sign(asymm::PlainText(serialised_public_key), signing_key);
+        SignerPolicy::Sign(typename SignerPolicy::PlainText(data.encoded_public_key.string()),
+                           signing_key);
     token.self_signature =
-        asymm::Sign(asymm::PlainText(token.signature_of_public_key.string() +
-                                     serialised_public_key.string() + ConvertToString(Tag::kValue)),
-                    keys_.private_key);
+        Policy::Sign(SelfSignedData(token.signature_of_public_key, data), data.keys.private_key);
     return token;
   }
 
-  void ValidateToken() const {
+  static void ValidateToken(const Data& data) {
+    ScopedTimer timer(Operation::kValidateToken, Tag::kValue);
     // Check the validation token is valid
-    if (!asymm::CheckSignature(asymm::PlainText(validation_token_.signature_of_public_key.string() +
-                                                asymm::EncodeKey(keys_.public_key).string() +
-                                                ConvertToString(Tag::kValue)),
-                               validation_token_.self_signature, keys_.public_key)) {
+    if (!Policy::CheckSignature(SelfSignedData(data.validation_token.signature_of_public_key, data),
+                               data.validation_token.self_signature, data.keys.public_key)) {
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
     }
     // Check the private key hasn't been replaced
-    asymm::PlainText plain(GetRandomString());
-    if (asymm::Decrypt(asymm::Encrypt(plain, keys_.public_key), keys_.private_key) != plain)
+    if (!Policy::KeysMatch(data.keys))
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
     // Check the name is the hash of the public key + validation token
-    if (CreateName() != name_.value)
+    if (CreateName(data) != data.name.value)
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
   }
 
-  asymm::Keys keys_;
-  ValidationToken validation_token_;
-  Name name_;
+  std::shared_ptr<const Data> data_;
 };
 
 
@@ -300,6 +389,9 @@ Fob<PmidTag> DecryptPmid(const crypto::CipherText& encrypted_pmid,
 
 #ifdef TESTING
 
+// The Read functions accept both the versioned key list format and the older unversioned one.
+// The Write functions (and GenerateKeyChains) only produce the versioned format (version 1),
+// which builds predating it can't read.  See README.md.
 std::vector<Fob<PmidTag>> ReadPmidList(const boost::filesystem::path& file_path);
 
 bool WritePmidList(const boost::filesystem::path& file_path,
@@ -319,11 +411,50 @@ struct AnmaidToPmid {
   Fob<PmidTag> pmid;
 };
 
+// Random access to the entries of a file written by WritePmidList (for 'Entry' == Fob<PmidTag>), or
+// by WriteKeyChainList or GenerateKeyChains (for 'Entry' == AnmaidToPmid).  The file is mapped into
+// memory and an entry is only decrypted and validated when it is requested via 'Get', so opening a
+// file with many thousands of entries costs next to nothing.  Files in the older unversioned format
+// are also accepted; these are read and split into encrypted entries on construction.  The
+// constructor throws if the file can't be read or isn't a valid list of the requested type.
+template <typename Entry>
+class KeyListReader {
+ public:
+  explicit KeyListReader(const boost::filesystem::path& file_path);
+  ~KeyListReader();
+  KeyListReader(KeyListReader&& other);
+  friend void swap(KeyListReader& lhs, KeyListReader& rhs) {
+    using std::swap;
+    swap(lhs.impl_, rhs.impl_);
+  }
+  KeyListReader& operator=(KeyListReader other);
+
+  std::size_t size() const;
+  // Throws if 'index' is out of range or the entry fails to decrypt or validate.
+  Entry Get(std::size_t index) const;
+
+ private:
+  KeyListReader(const KeyListReader&) = delete;
+
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+using PmidListReader = KeyListReader<Fob<PmidTag>>;
+using KeyChainListReader = KeyListReader<AnmaidToPmid>;
+
 std::vector<AnmaidToPmid> ReadKeyChainList(const boost::filesystem::path& file_path);
 
 bool WriteKeyChainList(const boost::filesystem::path& file_path,
                        const std::vector<AnmaidToPmid>& keychain_list);
 
+// Generates 'count' keychains using up to 'thread_count' threads (0 means one per hardware thread).
+// Each keychain is written to 'file_path' as soon as it has been created, in the format read by
+// ReadKeyChainList, so the full set is never held in memory.  The order of the keychains in the
+// file is unspecified.
+bool GenerateKeyChains(const boost::filesystem::path& file_path, std::size_t count,
+                       std::size_t thread_count = 0);
+
 #endif
 
 }  // namespace detail
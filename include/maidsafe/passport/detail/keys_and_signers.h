@@ -0,0 +1,127 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_PASSPORT_DETAIL_KEYS_AND_SIGNERS_H_
+#define MAIDSAFE_PASSPORT_DETAIL_KEYS_AND_SIGNERS_H_
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "maidsafe/common/error.h"
+#include "maidsafe/common/log.h"
+#include "maidsafe/common/types.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace detail {
+
+// Fob names are SHA-512 hashes, so their leading bytes are already uniformly distributed.
+struct NameHash {
+  std::size_t operator()(const Identity& name) const {
+    std::size_t hash(0);
+    std::memcpy(&hash, name.string().data(), std::min(sizeof(hash), name.string().size()));
+    return hash;
+  }
+};
+
+// Insertion-ordered collection of key and signer pairs, indexed by the names of both, so that
+// duplicate checks, lookup and removal are constant time.  Not thread-safe.
+template <typename Key>
+class KeysAndSigners {
+ public:
+  using KeyAndSigner = std::pair<Key, typename Key::Signer>;
+  using const_iterator = typename std::list<KeyAndSigner>::const_iterator;
+
+  KeysAndSigners() : keys_and_signers_(), key_index_(), signer_names_() {}
+
+  KeysAndSigners(KeysAndSigners&& other)
+      : keys_and_signers_(std::move(other.keys_and_signers_)),
+        key_index_(std::move(other.key_index_)),
+        signer_names_(std::move(other.signer_names_)) {}
+
+  friend void swap(KeysAndSigners& lhs, KeysAndSigners& rhs) {
+    using std::swap;
+    swap(lhs.keys_and_signers_, rhs.keys_and_signers_);
+    swap(lhs.key_index_, rhs.key_index_);
+    swap(lhs.signer_names_, rhs.signer_names_);
+  }
+
+  KeysAndSigners& operator=(KeysAndSigners other) {
+    swap(*this, other);
+    return *this;
+  }
+
+  // Throws if the key or signer already exists.
+  void Add(KeyAndSigner key_and_signer) {
+    const Identity& key_name(key_and_signer.first.name().value);
+    const Identity& signer_name(key_and_signer.second.name().value);
+    if (key_index_.count(key_name) != 0 || signer_names_.count(signer_name) != 0) {
+      LOG(kError) << "Key or signer already exists in passport - use unique keys and signers.";
+      BOOST_THROW_EXCEPTION(MakeError(PassportErrors::id_already_exists));
+    }
+    signer_names_.insert(signer_name);
+    keys_and_signers_.push_back(std::move(key_and_signer));
+    key_index_.emplace(keys_and_signers_.back().first.name().value,
+                       std::prev(std::end(keys_and_signers_)));
+  }
+
+  // Returns nullptr if the key doesn't exist.
+  const KeyAndSigner* Find(const typename Key::Name& key_name) const {
+    auto itr(key_index_.find(key_name.value));
+    return itr == std::end(key_index_) ? nullptr : &*itr->second;
+  }
+
+  // Removes the key and returns its signer.  Throws if the key doesn't exist.
+  typename Key::Signer Remove(const typename Key::Name& key_name) {
+    auto itr(key_index_.find(key_name.value));
+    if (itr == std::end(key_index_))
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::no_such_element));
+    auto list_itr(itr->second);
+    key_index_.erase(itr);
+    signer_names_.erase(list_itr->second.name().value);
+    typename Key::Signer signer{std::move(list_itr->second)};
+    keys_and_signers_.erase(list_itr);
+    return signer;
+  }
+
+  std::size_t size() const { return keys_and_signers_.size(); }
+  bool empty() const { return keys_and_signers_.empty(); }
+  const_iterator begin() const { return std::begin(keys_and_signers_); }
+  const_iterator end() const { return std::end(keys_and_signers_); }
+
+ private:
+  KeysAndSigners(const KeysAndSigners&) = delete;
+
+  std::list<KeyAndSigner> keys_and_signers_;
+  std::unordered_map<Identity, typename std::list<KeyAndSigner>::iterator, NameHash> key_index_;
+  std::unordered_set<Identity, NameHash> signer_names_;
+};
+
+}  // namespace detail
+
+}  // namespace passport
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_PASSPORT_DETAIL_KEYS_AND_SIGNERS_H_
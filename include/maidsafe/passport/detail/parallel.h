@@ -0,0 +1,84 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_PASSPORT_DETAIL_PARALLEL_H_
+#define MAIDSAFE_PASSPORT_DETAIL_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace detail {
+
+// Invokes 'functor(index)' for every index in [0, count) using up to 'thread_count' threads (0 means
+// one per hardware thread), one of which is the calling thread.  Indices are handed out one at a
+// time, so items of uneven cost are balanced across the threads.  'functor' must be safe to call
+// concurrently.  If it throws, no further indices are handed out and the first exception is
+// rethrown once all threads have finished.
+template <typename Functor>
+void ParallelFor(std::size_t count, Functor functor, std::size_t thread_count = 0) {
+  if (thread_count == 0)
+    thread_count = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  thread_count = std::min(thread_count, count);
+  std::atomic<std::size_t> next_index(0);
+  auto worker = [&] {
+    try {
+      for (std::size_t index(next_index++); index < count; index = next_index++)
+        functor(index);
+    } catch (...) {
+      next_index = count;
+      throw;
+    }
+  };
+
+  std::vector<std::future<void>> futures;
+  for (std::size_t i(1); i < thread_count; ++i)
+    futures.emplace_back(std::async(std::launch::async, worker));
+  std::exception_ptr error;
+  try {
+    worker();
+  } catch (...) {
+    error = std::current_exception();
+  }
+  for (auto& future : futures) {
+    try {
+      future.get();
+    } catch (...) {
+      if (!error)
+        error = std::current_exception();
+    }
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+}  // namespace detail
+
+}  // namespace passport
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_PASSPORT_DETAIL_PARALLEL_H_
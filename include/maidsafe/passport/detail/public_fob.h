@@ -19,14 +19,24 @@
 #ifndef MAIDSAFE_PASSPORT_DETAIL_PUBLIC_FOB_H_
 #define MAIDSAFE_PASSPORT_DETAIL_PUBLIC_FOB_H_
 
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
 #include <string>
 #include <type_traits>
 
+#include "cereal/archives/binary.hpp"
+#include "cereal/types/string.hpp"
+
 #include "maidsafe/common/rsa.h"
 #include "maidsafe/common/types.h"
 
+#include "maidsafe/passport/metrics.h"
 #include "maidsafe/passport/detail/config.h"
 #include "maidsafe/passport/detail/fob.h"
+#include "maidsafe/passport/detail/public_fob_cache.h"
 
 #include "maidsafe/common/serialisation/serialisation.h"
 
@@ -36,6 +46,29 @@ namespace passport {
 
 namespace detail {
 
+// A read-only std::streambuf over a caller-owned byte range, so that it can be deserialised in
+// place.
+class ByteRangeStreamBuf : public std::streambuf {
+ public:
+  ByteRangeStreamBuf(const byte* data, std::size_t size) {
+    // The get area is never written to, despite std::streambuf requiring non-const pointers.
+    char* begin(const_cast<char*>(reinterpret_cast<const char*>(data)));
+    setg(begin, begin, begin + size);
+  }
+};
+
+// Reads a serialised PublicFob's encoded public key and validation token directly from the 'size'
+// bytes at 'serialised_public_fob'.  The input isn't copied; the only allocations are for the
+// decoded fields.  Throws if the bytes can't be parsed.
+template <typename ValidationToken>
+void ParsePublicFobFields(const byte* serialised_public_fob, std::size_t size,
+                          std::string& encoded_public_key, ValidationToken& validation_token) {
+  ByteRangeStreamBuf stream_buffer(serialised_public_fob, size);
+  std::istream input_stream(&stream_buffer);
+  cereal::BinaryInputArchive archive(input_stream);
+  archive(encoded_public_key, validation_token);
+}
+
 template <typename TagType>
 class PublicFob {
  public:
@@ -44,21 +77,18 @@ class PublicFob {
   using Signer = Fob<typename SignerFob<TagType>::Tag>;
   using serialised_type = TaggedValue<NonEmptyString, Tag>;
   using ValidationToken = typename Fob<Tag>::ValidationToken;
+  using Policy = typename Fob<Tag>::Policy;
+  using EncodedPublicKey = typename Policy::EncodedPublicKey;
 
   PublicFob() = default;
 
   PublicFob(const PublicFob& other) = default;
 
-  PublicFob(PublicFob&& other)
-      : name_(std::move(other.name_)),
-        public_key_(std::move(other.public_key_)),
-        validation_token_(std::move(other.validation_token_)) {}
+  PublicFob(PublicFob&& other) : data_(std::move(other.data_)) {}
 
   friend void swap(PublicFob& lhs, PublicFob& rhs) {
     using std::swap;
-    swap(lhs.name_, rhs.name_);
-    swap(lhs.public_key_, rhs.public_key_);
-    swap(lhs.validation_token_, rhs.validation_token_);
+    swap(lhs.data_, rhs.data_);
   }
 
   PublicFob& operator=(PublicFob other) {
@@ -67,49 +97,85 @@ class PublicFob {
   }
 
   explicit PublicFob(const Fob<Tag>& fob)
-      : name_(fob.name()),
-        public_key_(fob.public_key()),
-        validation_token_(fob.validation_token()) {}
+      : data_(std::make_shared<const Data>(Name(fob.name()), fob.public_key(),
+                                           fob.encoded_public_key(), fob.validation_token())) {}
 
+  // If the PublicFobCache for this type is enabled and already holds this fob, the fob shares the
+  // cached key rather than decoding and validating it again.
   PublicFob(Name name, const serialised_type& serialised_public_fob)
-      : name_(std::move(name)), public_key_(), validation_token_() {
+      : PublicFob(std::move(name),
+                  reinterpret_cast<const byte*>(serialised_public_fob.data.string().data()),
+                  serialised_public_fob.data.string().size()) {}
+
+  // As above, but parses 'size' bytes at 'serialised_public_fob' (e.g. a network receive buffer)
+  // without the caller first having to wrap them in a serialised_type.  The bytes are only read
+  // during this call.
+  PublicFob(Name name, const byte* serialised_public_fob, std::size_t size) : data_() {
+    ScopedTimer timer(Operation::kPublicFobParse, Tag::kValue);
+    auto& cache(PublicFobCache<Tag>::Instance());
+    std::string cache_key;
+    if (cache.Enabled()) {
+      cache_key = cache.MakeKey(name.value, serialised_public_fob, size);
+      if ((data_ = cache.Find(cache_key)))
+        return;
+    }
     try {
-      maidsafe::ConvertFromString(serialised_public_fob.data.string(), *this);
+      std::string raw_public_key;
+      ValidationToken validation_token;
+      ParsePublicFobFields(serialised_public_fob, size, raw_public_key, validation_token);
+      data_ = MakeData(std::move(name), EncodedPublicKey(std::move(raw_public_key)),
+                       std::move(validation_token));
     } catch (...) {
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
     }
+    if (!cache_key.empty())
+      cache.Insert(std::move(cache_key), data_);
   }
 
+  // The serialised form is computed on the first call and then held in the fob's shared data block,
+  // so later calls (on this fob or any copy of it) return a copy of it without re-serialising.
   serialised_type Serialise() const {
-    return serialised_type(NonEmptyString{maidsafe::ConvertToString(*this)});
+    if (!IsInitialised())
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::uninitialised));
+    std::call_once(data_->serialise_flag, [this] {
+      data_->serialised = serialised_type(NonEmptyString{maidsafe::ConvertToString(*this)});
+    });
+    return data_->serialised;
   }
 
-  bool IsInitialised() const { return name_->IsInitialised(); }
+  bool IsInitialised() const { return data_ && data_->name->IsInitialised(); }
 
-  Name name() const {
+  // As for Fob, copies share one immutable block, so the references returned by these remain valid
+  // until this PublicFob is destroyed or assigned to.
+  const Name& name() const {
     if (!IsInitialised())
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::uninitialised));
-    return name_;
+    return data_->name;
   }
 
-  asymm::PublicKey public_key() const {
+  const typename Policy::PublicKey& public_key() const {
     if (!IsInitialised())
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::uninitialised));
-    return public_key_;
+    return data_->public_key;
   }
 
-  ValidationToken validation_token() const {
+  const ValidationToken& validation_token() const {
     if (!IsInitialised())
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::uninitialised));
-    return validation_token_;
+    return data_->validation_token;
   }
 
+  // The fob's name must already be set (e.g. via the (Name, serialised_type) constructor) since it
+  // is validated against the loaded key.
   template <typename Archive>
   Archive& load(Archive& archive) {
+    ScopedTimer timer(Operation::kPublicFobParse, Tag::kValue);
     std::string temp_raw_public_key;
-    archive(temp_raw_public_key, validation_token_);
-    public_key_ = asymm::DecodeKey(asymm::EncodedPublicKey(temp_raw_public_key));
-    ValidateToken(temp_raw_public_key);
+    ValidationToken validation_token;
+    archive(temp_raw_public_key, validation_token);
+    data_ = MakeData(data_ ? data_->name : Name(),
+                     EncodedPublicKey(std::move(temp_raw_public_key)),
+                     std::move(validation_token));
     return archive;
   }
 
@@ -117,47 +183,84 @@ class PublicFob {
   Archive& save(Archive& archive) const {
     if (!IsInitialised())
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::uninitialised));
-    return archive(asymm::EncodeKey(public_key_).string(), validation_token_);
+    return archive(data_->encoded_public_key.string(), data_->validation_token);
   }
 
  private:
+  friend class PublicFobCache<Tag>;
+
+  // As for Fob, the encoded public key is kept alongside the decoded one.  'serialised' is filled
+  // lazily by Serialise() under 'serialise_flag'.
+  struct Data {
+    Data(Name name_in, typename Policy::PublicKey public_key_in,
+         EncodedPublicKey encoded_public_key_in, ValidationToken validation_token_in)
+        : name(std::move(name_in)),
+          public_key(std::move(public_key_in)),
+          encoded_public_key(std::move(encoded_public_key_in)),
+          validation_token(std::move(validation_token_in)),
+          serialise_flag(),
+          serialised() {}
+
+    Name name;
+    typename Policy::PublicKey public_key;
+    EncodedPublicKey encoded_public_key;
+    ValidationToken validation_token;
+    mutable std::once_flag serialise_flag;
+    mutable serialised_type serialised;
+  };
+
+  static std::shared_ptr<const Data> MakeData(Name name, EncodedPublicKey encoded_public_key,
+                                              ValidationToken validation_token) {
+    typename Policy::PublicKey public_key(Policy::DecodeKey(encoded_public_key));
+    auto data(std::make_shared<const Data>(std::move(name), std::move(public_key),
+                                           std::move(encoded_public_key),
+                                           std::move(validation_token)));
+    ValidateToken(*data);
+    return data;
+  }
+
   // For self-signed keys
   template <typename T = TagType>
-  void ValidateToken(
-      const std::string& encoded_public_key,
-      typename std::enable_if<std::is_same<Fob<T>, Signer>::value>::type* = 0) const {
+  static void ValidateToken(
+      const Data& data,
+      typename std::enable_if<std::is_same<Fob<T>, Signer>::value>::type* = 0) {
+    ScopedTimer timer(Operation::kValidateToken, Tag::kValue);
+    const std::string& encoded_public_key(data.encoded_public_key.string());
     // Check the validation token is valid
-    if (!asymm::CheckSignature(asymm::PlainText(encoded_public_key + ConvertToString(Tag::kValue)),
-                               validation_token_, public_key_)) {
+    if (!Policy::CheckSignature(typename Policy::PlainText(encoded_public_key + TagSuffix<Tag>()),
+                                data.validation_token, data.public_key)) {
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
     }
     // Check the name is the hash of the public key + validation token
-    if (crypto::Hash<crypto::SHA512>(encoded_public_key + validation_token_.string()) !=
-        name_.value) {
+    if (crypto::Hash<crypto::SHA512>(encoded_public_key +
+                                     Policy::SignatureBytes(data.validation_token)) !=
+        data.name.value) {
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
     }
   }
 
   // For non-self-signed keys
   template <typename T = TagType>
-  void ValidateToken(
-      const std::string& encoded_public_key,
-      typename std::enable_if<!std::is_same<Fob<T>, Signer>::value>::type* = 0) const {
+  static void ValidateToken(
+      const Data& data,
+      typename std::enable_if<!std::is_same<Fob<T>, Signer>::value>::type* = 0) {
+    ScopedTimer timer(Operation::kValidateToken, Tag::kValue);
+    const std::string& encoded_public_key(data.encoded_public_key.string());
     // Check the validation token is valid
-    if (!asymm::CheckSignature(asymm::PlainText(validation_token_.signature_of_public_key.string() +
-                                                encoded_public_key + ConvertToString(Tag::kValue)),
-                               validation_token_.self_signature, public_key_)) {
+    if (!Policy::CheckSignature(
+            typename Policy::PlainText(
+                Signer::Policy::SignatureBytes(data.validation_token.signature_of_public_key) +
+                encoded_public_key + TagSuffix<Tag>()),
+            data.validation_token.self_signature, data.public_key)) {
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
     }
     // Check the name is the hash of the public key + validation token
-    if (crypto::Hash<crypto::SHA512>(encoded_public_key + ConvertToString(validation_token_)) !=
-        name_.value)
+    if (crypto::Hash<crypto::SHA512>(encoded_public_key + ConvertToString(data.validation_token)) !=
+        data.name.value)
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
   }
 
-  Name name_;
-  asymm::PublicKey public_key_;
-  ValidationToken validation_token_;
+  std::shared_ptr<const Data> data_;
 };
 
 }  // namespace detail
@@ -0,0 +1,148 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_PASSPORT_DETAIL_PUBLIC_FOB_CACHE_H_
+#define MAIDSAFE_PASSPORT_DETAIL_PUBLIC_FOB_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "cryptopp/sha.h"
+
+#include "maidsafe/common/types.h"
+
+#include "maidsafe/passport/detail/config.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace detail {
+
+template <typename TagType>
+class PublicFob;
+
+struct PublicFobCacheStats {
+  std::uint64_t hits;
+  std::uint64_t misses;
+  std::size_t size;
+  std::size_t capacity;
+};
+
+// Bounded, thread-safe, least-recently-used cache of PublicFobs which have already been parsed and
+// validated, keyed by the fob's name and a hash of its serialised form.  A repeated parse of the same
+// serialised fob can then skip decoding the key and checking its signature.  Entries are the
+// PublicFobs' own immutable data blocks, so a hit shares the cached block rather than copying it.
+// There is one cache per tag type; it is disabled (capacity of 0) until 'SetCapacity' is called.
+template <typename TagType>
+class PublicFobCache {
+ public:
+  using Entry = typename PublicFob<TagType>::Data;
+
+  static PublicFobCache& Instance() {
+    static PublicFobCache instance;
+    return instance;
+  }
+
+  // Setting the capacity to 0 disables the cache and discards all entries.
+  void SetCapacity(std::size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = capacity;
+    Trim();
+  }
+
+  bool Enabled() const { return capacity_ != 0; }
+
+  // Hashes the serialised bytes in place, so they needn't be copied into a string first.
+  static std::string MakeKey(const Identity& name, const byte* serialised_public_fob,
+                             std::size_t size) {
+    std::string key(name.string());
+    const std::size_t name_size(key.size());
+    key.resize(name_size + CryptoPP::SHA512::DIGESTSIZE);
+    CryptoPP::SHA512().CalculateDigest(reinterpret_cast<byte*>(&key[name_size]),
+                                       serialised_public_fob, size);
+    return key;
+  }
+
+  // Returns nullptr if 'key' isn't in the cache.
+  std::shared_ptr<const Entry> Find(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto itr(index_.find(key));
+    if (itr == std::end(index_)) {
+      ++misses_;
+      return nullptr;
+    }
+    ++hits_;
+    entries_.splice(std::begin(entries_), entries_, itr->second);
+    return itr->second->second;
+  }
+
+  void Insert(std::string key, std::shared_ptr<const Entry> entry) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (capacity_ == 0 || index_.count(key) != 0)
+      return;
+    entries_.emplace_front(std::move(key), std::move(entry));
+    index_.emplace(entries_.front().first, std::begin(entries_));
+    Trim();
+  }
+
+  PublicFobCacheStats GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PublicFobCacheStats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.size = index_.size();
+    stats.capacity = capacity_;
+    return stats;
+  }
+
+ private:
+  using Entries = std::list<std::pair<std::string, std::shared_ptr<const Entry>>>;
+
+  PublicFobCache() : entries_(), index_(), capacity_(0), hits_(0), misses_(0), mutex_() {}
+  PublicFobCache(const PublicFobCache&) = delete;
+  PublicFobCache(PublicFobCache&&) = delete;
+  PublicFobCache& operator=(PublicFobCache) = delete;
+
+  void Trim() {
+    while (index_.size() > capacity_) {
+      index_.erase(entries_.back().first);
+      entries_.pop_back();
+    }
+  }
+
+  Entries entries_;
+  std::unordered_map<std::string, typename Entries::iterator> index_;
+  std::atomic<std::size_t> capacity_;
+  std::uint64_t hits_, misses_;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace detail
+
+}  // namespace passport
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_PASSPORT_DETAIL_PUBLIC_FOB_CACHE_H_
@@ -0,0 +1,107 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_PASSPORT_DETAIL_SIGNATURE_POLICY_H_
+#define MAIDSAFE_PASSPORT_DETAIL_SIGNATURE_POLICY_H_
+
+#include <string>
+
+#include "maidsafe/common/rsa.h"
+
+#include "maidsafe/passport/detail/config.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace detail {
+
+// The signature scheme Fob and PublicFob use for key generation, signing, validation and encoding
+// of public keys.  Which policy a fob type uses is chosen by specialising SignaturePolicy (in
+// config.h).  Fob and PublicFob use nothing of a policy beyond the following, so a replacement
+// must provide exactly these:
+//
+//   Keys                  default-constructible, with members 'private_key' and 'public_key' of
+//                         the types below, and serialisable with cereal (Fob::Encrypt and the
+//                         decrypting Fob constructors serialise a fob's keys)
+//   PrivateKey, PublicKey copyable
+//   EncodedPublicKey      default-constructible, and constructible from and exposing via string()
+//                         its bytes
+//   Signature             default-constructible, serialisable with cereal and comparable with
+//                         operator== (it forms, or is part of, the validation token, which fobs
+//                         compare)
+//   PlainText             constructible from a std::string of the bytes to be signed
+//   kMinimumKeyBits       the smallest key size the scheme supports
+//   GenerateKeyPair(key_bits), Sign(plain_text, private_key),
+//   CheckSignature(plain_text, signature, public_key), EncodeKey(public_key),
+//   DecodeKey(encoded_public_key), KeyBits(public_key), KeysMatch(keys)
+//   SignatureBytes(signature)  the signature's bytes as a std::string, which are hashed into
+//                              fob names and signed into non-self-signed fobs' validation tokens
+//
+// This is RSA with PSS padding (as implemented by maidsafe::asymm), and is the default for all fob
+// types.
+struct RsaPssPolicy {
+  using Keys = asymm::Keys;
+  using PrivateKey = asymm::PrivateKey;
+  using PublicKey = asymm::PublicKey;
+  using EncodedPublicKey = asymm::EncodedPublicKey;
+  using Signature = asymm::Signature;
+  using PlainText = asymm::PlainText;
+
+  // RSA-PSS with SHA-512 needs a modulus of more than 1040 bits.
+  static const unsigned kMinimumKeyBits = 1536;
+
+  // Generates the key pair directly with CryptoPP, since asymm::GenerateKeyPair has a fixed size.
+  static Keys GenerateKeyPair(unsigned key_bits);
+
+  static Signature Sign(const PlainText& data, const PrivateKey& private_key) {
+    return asymm::Sign(data, private_key);
+  }
+
+  static bool CheckSignature(const PlainText& data, const Signature& signature,
+                             const PublicKey& public_key) {
+    return asymm::CheckSignature(data, signature, public_key);
+  }
+
+  static EncodedPublicKey EncodeKey(const PublicKey& public_key) {
+    return asymm::EncodeKey(public_key);
+  }
+
+  static PublicKey DecodeKey(const EncodedPublicKey& encoded_public_key) {
+    return asymm::DecodeKey(encoded_public_key);
+  }
+
+  static unsigned KeyBits(const PublicKey& public_key) {
+    return static_cast<unsigned>(public_key.GetModulus().BitCount());
+  }
+
+  // Checks a decrypted fob's private key hasn't been replaced, i.e. that 'keys.private_key' is the
+  // private half of 'keys.public_key'.  This gives the same assurance as an encrypt/decrypt round
+  // trip, but without any modular exponentiation.
+  static bool KeysMatch(const Keys& keys);
+
+  static std::string SignatureBytes(const Signature& signature) { return signature.string(); }
+};
+
+}  // namespace detail
+
+}  // namespace passport
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_PASSPORT_DETAIL_SIGNATURE_POLICY_H_
@@ -0,0 +1,99 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_PASSPORT_KEY_POOL_H_
+#define MAIDSAFE_PASSPORT_KEY_POOL_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "maidsafe/common/rsa.h"
+
+#include "maidsafe/passport/detail/config.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+// RSA key generation is by far the most expensive part of creating a Fob.  The KeyPool holds a
+// number of pre-generated key pairs which are kept topped up by background worker threads, so that
+// bursts of Fob construction (e.g. account creation) only pay the cost of signing.  The keys
+// handed out can be passed to the Fob constructors which accept an 'asymm::Keys'.  The pool holds
+// keys of a single size; since those constructors reject keys of the wrong size for their fob type
+// (see detail::KeySize), use 'Get<TagType>()' to obtain keys for a particular type.
+class KeyPool {
+ public:
+  struct Stats {
+    std::uint64_t hits;      // Number of requests served from the pool.
+    std::uint64_t misses;    // Number of requests which found the pool empty.
+    std::uint64_t failures;  // Number of failed key generations by the worker threads.
+    std::size_t available;
+  };
+
+  // Starts 'worker_count' threads which generate key pairs of 'key_bits' until 'depth' of them are
+  // available.  A worker whose key generation fails waits before retrying, doubling the wait (up to
+  // 30 seconds) with each consecutive failure.  Throws if either 'depth' or 'worker_count' is 0, or
+  // if 'key_bits' is smaller than the signature policy's minimum key size.
+  KeyPool(std::size_t depth, std::size_t worker_count,
+          unsigned key_bits = detail::kDefaultKeyBits);
+  ~KeyPool();
+
+  // Returns a pre-generated key pair if one is available, otherwise generates a new one on the
+  // calling thread.
+  asymm::Keys Get();
+
+  // As above if 'key_bits' is the pool's key size, otherwise always generates a new key pair of
+  // 'key_bits' on the calling thread (counted as a miss).
+  asymm::Keys Get(unsigned key_bits);
+
+  // Returns a key pair of the size used by fobs of type 'TagType'.
+  template <typename TagType>
+  asymm::Keys Get() {
+    return Get(static_cast<unsigned>(detail::KeySize<TagType>::kBits));
+  }
+
+  Stats GetStats() const;
+
+ private:
+  KeyPool(const KeyPool&) = delete;
+  KeyPool(KeyPool&&) = delete;
+  KeyPool& operator=(KeyPool) = delete;
+
+  void Stop();
+  void Run();
+
+  const std::size_t depth_;
+  const unsigned key_bits_;
+  std::deque<asymm::Keys> keys_;
+  std::size_t pending_;
+  std::uint64_t hits_, misses_, failures_;
+  bool stopped_;
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace passport
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_PASSPORT_KEY_POOL_H_
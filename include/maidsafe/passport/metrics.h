@@ -0,0 +1,141 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_PASSPORT_METRICS_H_
+#define MAIDSAFE_PASSPORT_METRICS_H_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "boost/thread/shared_mutex.hpp"
+
+#include "maidsafe/passport/tracing.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+// The operations for which counts and latencies are recorded while metrics are enabled.
+enum class Operation {
+  kKeyGeneration,           // Generating a fob's key pair.
+  kCreateValidationToken,   // Signing a new fob's validation token.
+  kValidateToken,           // Checking a Fob's or PublicFob's validation token.
+  kFobEncrypt,
+  kFobDecrypt,              // Includes validating the decrypted fob.
+  kPublicFobParse,          // Includes validating the parsed fob, unless it was already cached.
+  kSessionCreation,         // Deriving a PassportSession's keys from the user's credentials.
+  kPassportSave,            // Passport::Encrypt.
+  kPassportLoad,            // Constructing a Passport from its encrypted form.
+  kPassportLockWait         // Time spent blocked waiting for a Passport's lock.
+};
+
+const std::size_t kOperationCount = static_cast<std::size_t>(Operation::kPassportLockWait) + 1;
+const std::size_t kLatencyBucketCount = 32;
+
+struct OperationMetrics {
+  std::uint64_t count;
+  std::uint64_t total_microseconds;
+  // 'latency_histogram[i]' is the number of operations which took from 2^i to 2^(i+1) - 1
+  // microseconds.  The first bucket also holds those taking under a microsecond, and the last
+  // everything longer than it covers.
+  std::array<std::uint64_t, kLatencyBucketCount> latency_histogram;
+};
+
+struct Metrics {
+  const OperationMetrics& operator[](Operation operation) const {
+    return operations[static_cast<std::size_t>(operation)];
+  }
+
+  std::array<OperationMetrics, kOperationCount> operations;
+};
+
+// Metrics are disabled by default.  While neither metrics nor tracing is enabled, each timed
+// operation costs two relaxed atomic loads (one for each) and nothing else.
+void EnableMetrics(bool enable);
+bool MetricsEnabled();
+
+// Returns the metrics recorded since the process started or 'ResetMetrics' was last called.  Each
+// counter is read atomically, but operations completing during the call may be partially included.
+Metrics GetMetrics();
+void ResetMetrics();
+
+const char* OperationName(Operation operation);
+
+namespace detail {
+
+// Records the time from construction to destruction as one 'operation', if metrics were enabled
+// at construction.  The operation is also recorded as a trace event (named after the operation and
+// labelled with 'fob_type', if given) while tracing.
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(Operation operation);
+  ScopedTimer(Operation operation, DataTagValue fob_type);
+  ~ScopedTimer();
+
+ private:
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer(ScopedTimer&&) = delete;
+  ScopedTimer& operator=(ScopedTimer) = delete;
+
+  const Operation operation_;
+  const bool enabled_;
+  const std::chrono::steady_clock::time_point start_;
+  ScopedTraceEvent trace_event_;
+};
+
+// A boost::shared_mutex which records, as kPassportLockWait, any acquisition which can't be made
+// immediately.  Uncontended acquisitions aren't timed.
+class TimedSharedMutex {
+ public:
+  TimedSharedMutex() : mutex_() {}
+
+  void lock() {
+    if (!mutex_.try_lock()) {
+      ScopedTimer timer(Operation::kPassportLockWait);
+      mutex_.lock();
+    }
+  }
+  bool try_lock() { return mutex_.try_lock(); }
+  void unlock() { mutex_.unlock(); }
+
+  void lock_shared() {
+    if (!mutex_.try_lock_shared()) {
+      ScopedTimer timer(Operation::kPassportLockWait);
+      mutex_.lock_shared();
+    }
+  }
+  bool try_lock_shared() { return mutex_.try_lock_shared(); }
+  void unlock_shared() { mutex_.unlock_shared(); }
+
+ private:
+  TimedSharedMutex(const TimedSharedMutex&) = delete;
+  TimedSharedMutex(TimedSharedMutex&&) = delete;
+  TimedSharedMutex& operator=(TimedSharedMutex) = delete;
+
+  boost::shared_mutex mutex_;
+};
+
+}  // namespace detail
+
+}  // namespace passport
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_PASSPORT_METRICS_H_
@@ -19,18 +19,27 @@
 #ifndef MAIDSAFE_PASSPORT_PASSPORT_H_
 #define MAIDSAFE_PASSPORT_PASSPORT_H_
 
+#include <functional>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "boost/thread/shared_mutex.hpp"
+
 #include "maidsafe/common/crypto.h"
 #include "maidsafe/common/error.h"
 #include "maidsafe/common/log.h"
 #include "maidsafe/common/types.h"
 
+#include "maidsafe/passport/key_pool.h"
+#include "maidsafe/passport/metrics.h"
 #include "maidsafe/passport/types.h"
+#include "maidsafe/passport/detail/keys_and_signers.h"
+#include "maidsafe/passport/detail/parallel.h"
 
 namespace maidsafe {
 
@@ -71,6 +80,16 @@ Anpmid DecryptAnpmid(const crypto::CipherText& encrypted_anpmid, const crypto::A
 Pmid DecryptPmid(const crypto::CipherText& encrypted_pmid, const crypto::AES256Key& symm_key,
                  const crypto::AES256InitialisationVector& symm_iv);
 
+// Parses each of 'serialised_public_keys' (e.g. a group of PublicPmids) using up to 'thread_count'
+// threads (0 means one per hardware thread).  Unlike the PublicKeyType constructor, this doesn't
+// throw for invalid entries.  The result holds one element per input, in the same order, and invalid
+// entries are left uninitialised (i.e. their 'IsInitialised()' returns false).
+template <typename PublicKeyType>
+std::vector<PublicKeyType> ParsePublicKeys(
+    const std::vector<std::pair<typename PublicKeyType::Name,
+                                typename PublicKeyType::serialised_type>>& serialised_public_keys,
+    std::size_t thread_count = 0);
+
 using MaidAndSigner = std::pair<Maid, Maid::Signer>;
 using PmidAndSigner = std::pair<Pmid, Pmid::Signer>;
 using MpidAndSigner = std::pair<Mpid, Mpid::Signer>;
@@ -78,6 +97,76 @@ using MpidAndSigner = std::pair<Mpid, Mpid::Signer>;
 MaidAndSigner CreateMaidAndSigner();
 PmidAndSigner CreatePmidAndSigner();
 MpidAndSigner CreateMpidAndSigner();
+// As above, but take the key pairs from 'key_pool' rather than generating them inline.
+MaidAndSigner CreateMaidAndSigner(KeyPool& key_pool);
+PmidAndSigner CreatePmidAndSigner(KeyPool& key_pool);
+MpidAndSigner CreateMpidAndSigner(KeyPool& key_pool);
+
+// Asynchronous versions of the above.  The key pair of the signed key is generated concurrently with
+// the signer, and only the final signing step waits for both.  The versions taking no arguments run
+// on internally-launched threads, the others post their work to 'executor', which must eventually
+// run every function posted to it.  Errors are reported via the returned future.
+using Executor = std::function<void(std::function<void()>)>;
+std::future<MaidAndSigner> CreateMaidAndSignerAsync();
+std::future<PmidAndSigner> CreatePmidAndSignerAsync();
+std::future<MpidAndSigner> CreateMpidAndSignerAsync();
+std::future<MaidAndSigner> CreateMaidAndSignerAsync(const Executor& executor);
+std::future<PmidAndSigner> CreatePmidAndSignerAsync(const Executor& executor);
+std::future<MpidAndSigner> CreateMpidAndSignerAsync(const Executor& executor);
+
+// Holds the symmetric key material derived from a user's credentials, so that the deliberately slow
+// derivation (PBKDF2) is paid once per login rather than on every encryption of the passport.
+class PassportSession {
+ public:
+  // Throws if any of the user credential fields are null.
+  explicit PassportSession(const authentication::UserCredentials& user_credentials);
+  ~PassportSession();
+
+ private:
+  friend class Passport;
+  PassportSession(const PassportSession&) = delete;
+  PassportSession(PassportSession&&) = delete;
+  PassportSession& operator=(PassportSession) = delete;
+
+  // Copy of the credentials, required to obfuscate/deobfuscate the serialised passport.
+  std::unique_ptr<authentication::UserCredentials> user_credentials_;
+  crypto::AES256Key symm_key_;
+  crypto::AES256InitialisationVector symm_iv_;
+};
+
+// Determines when the keys of an encrypted passport are decrypted and validated.  In eager mode, all
+// keys are processed on construction.  In lazy mode only the Maid is; the Pmids and the Mpids are
+// kept encrypted until keys of that type are first accessed (via any function which gets, finds,
+// iterates over, adds or removes them), so that function may throw a parsing error instead.
+enum class DecryptionMode { kEager, kLazy };
+
+namespace detail {
+
+using EncryptedKeyAndSigner = std::pair<crypto::CipherText, crypto::CipherText>;
+
+// A set of encrypted keys and signers, along with the key material they were encrypted with.
+struct EncryptedKeysAndSigners {
+  std::vector<EncryptedKeyAndSigner> keys_and_signers;
+  crypto::AES256Key symm_key;
+  crypto::AES256InitialisationVector symm_iv;
+};
+
+// The most recently written ciphertexts of a passport's keys and signers, indexed by key name.  These
+// are only valid for the key material they were encrypted with.  Since fobs are immutable, an entry
+// can be reused for as long as its key remains in the passport paired with the same signer; a key
+// may be removed and re-added with a different signer, so the signer's name is checked too.
+struct CachedCiphertext {
+  Identity signer_name;
+  std::shared_ptr<const EncryptedKeyAndSigner> ciphertexts;
+};
+
+struct CachedCiphertexts {
+  crypto::AES256Key symm_key;
+  crypto::AES256InitialisationVector symm_iv;
+  std::unordered_map<Identity, CachedCiphertext, NameHash> entries;
+};
+
+}  // namespace detail
 
 // The Passport class contains identity types for the various network related tasks available, see
 // types.h for details about the identity types.
@@ -88,10 +177,18 @@ class Passport {
   // Constructs from a previously-encrypted passport.  All fields of 'user_credentials' must be
   // identical to those used during the encryption.  Throws if unable to decrypt and parse.
   Passport(const crypto::CipherText& encrypted_passport,
-           const authentication::UserCredentials& user_credentials);
+           const authentication::UserCredentials& user_credentials,
+           DecryptionMode mode = DecryptionMode::kEager);
+  // As above, but using key material previously derived by 'session'.
+  Passport(const crypto::CipherText& encrypted_passport, const PassportSession& session,
+           DecryptionMode mode = DecryptionMode::kEager);
   // Serialises and encrypts the entire contents of the passport.  Throws if any of the user
-  // credential fields are null, or if the passport doesn't contain a Maid.
+  // credential fields are null, or if the passport doesn't contain a Maid.  Pmids and Mpids which
+  // were already encrypted with the same key material (when the passport was last decrypted or
+  // encrypted) aren't encrypted again, so the cost of repeated saves depends on what has changed.
   crypto::CipherText Encrypt(const authentication::UserCredentials& user_credentials) const;
+  // As above, but avoids re-deriving the key material by using that held by 'session'.
+  crypto::CipherText Encrypt(const PassportSession& session) const;
 
   // Throws if the passport doesn't contain a Maid.
   Maid GetMaid() const;
@@ -100,10 +197,22 @@ class Passport {
   void AddKeyAndSigner(PmidAndSigner pmid_and_signer);
   void AddKeyAndSigner(MpidAndSigner mpid_and_signer);
 
-  // Returns all the keys of the given type (may be empty).  Doesn't throw.
+  // Returns all the keys of the given type (may be empty).  Doesn't throw, except in lazy mode as
+  // described for DecryptionMode.
   std::vector<Pmid> GetPmids() const;
   std::vector<Mpid> GetMpids() const;
 
+  // Returns the key with the given name.  Throws if it doesn't exist.
+  Pmid FindPmid(const Pmid::Name& pmid_name) const;
+  Mpid FindMpid(const Mpid::Name& mpid_name) const;
+
+  // Invokes 'functor' with a const reference to each key of the given type in turn, without copying
+  // the keys.  A shared lock is held throughout, so 'functor' must not call back into this passport.
+  template <typename Functor>
+  void ForEachPmid(Functor functor) const;
+  template <typename Functor>
+  void ForEachMpid(Functor functor) const;
+
   // To invalidate a key on the network, the revocation message must be signed by the corresponding
   // signer key.  This function returns the original signing key for 'key_to_be_removed'.  If 'Key'
   // type is Maid, the passport can no longer be serialised via 'Encrypt' (used when destroying an
@@ -124,19 +233,67 @@ class Passport {
   Passport& operator=(Passport) = delete;
 
   void FromString(const NonEmptyString& serialised_passport, const crypto::AES256Key& symm_key,
-                  const crypto::AES256InitialisationVector& symm_iv);
+                  const crypto::AES256InitialisationVector& symm_iv, DecryptionMode mode);
   NonEmptyString ToString(const crypto::AES256Key& symm_key,
                           const crypto::AES256InitialisationVector& symm_iv) const;
 
   void Decrypt(const crypto::CipherText& encrypted_passport,
                const authentication::UserCredentials& user_credentials);
 
+  // In lazy mode, decrypts and installs the pending keys of the given type if that hasn't happened
+  // yet.  No-ops otherwise.
+  void DecryptPendingPmids() const;
+  void DecryptPendingMpids() const;
+
   std::unique_ptr<MaidAndSigner> maid_and_signer_;
-  std::vector<PmidAndSigner> pmids_and_signers_;
-  std::vector<MpidAndSigner> mpids_and_signers_;
-  mutable std::mutex mutex_;
+  // These are mutable since, in lazy mode, they're only filled on first access.  Once filled, the
+  // corresponding encrypted set is reset and is never set again.
+  mutable detail::KeysAndSigners<Pmid> pmids_and_signers_;
+  mutable detail::KeysAndSigners<Mpid> mpids_and_signers_;
+  mutable std::shared_ptr<const detail::EncryptedKeysAndSigners> encrypted_pmids_and_signers_;
+  mutable std::shared_ptr<const detail::EncryptedKeysAndSigners> encrypted_mpids_and_signers_;
+  // Replaced as a whole after each encryption, so readers can use a snapshot without the lock.
+  mutable std::shared_ptr<const detail::CachedCiphertexts> pmid_ciphertexts_;
+  mutable std::shared_ptr<const detail::CachedCiphertexts> mpid_ciphertexts_;
+  // Shared by readers (getters and 'Encrypt'), exclusive for modifiers.
+  mutable detail::TimedSharedMutex mutex_;
 };
 
+template <typename PublicKeyType>
+std::vector<PublicKeyType> ParsePublicKeys(
+    const std::vector<std::pair<typename PublicKeyType::Name,
+                                typename PublicKeyType::serialised_type>>& serialised_public_keys,
+    std::size_t thread_count) {
+  static_assert(is_public_key_type<PublicKeyType>::value,
+                "ParsePublicKeys is only applicable to the public key types.");
+  std::vector<PublicKeyType> public_keys(serialised_public_keys.size());
+  detail::ParallelFor(serialised_public_keys.size(), [&](std::size_t index) {
+    try {
+      public_keys[index] =
+          PublicKeyType(serialised_public_keys[index].first, serialised_public_keys[index].second);
+    } catch (const std::exception& e) {
+      LOG(kWarning) << "Failed to parse public key at index " << index << ": " << e.what();
+    }
+  }, thread_count);
+  return public_keys;
+}
+
+template <typename Functor>
+void Passport::ForEachPmid(Functor functor) const {
+  DecryptPendingPmids();
+  boost::shared_lock<detail::TimedSharedMutex> lock{mutex_};
+  for (const auto& pmid_and_signer : pmids_and_signers_)
+    functor(pmid_and_signer.first);
+}
+
+template <typename Functor>
+void Passport::ForEachMpid(Functor functor) const {
+  DecryptPendingMpids();
+  boost::shared_lock<detail::TimedSharedMutex> lock{mutex_};
+  for (const auto& mpid_and_signer : mpids_and_signers_)
+    functor(mpid_and_signer.first);
+}
+
 template <>
 Maid::Signer Passport::RemoveKeyAndSigner<Maid>(const Maid& key_to_be_removed);
 template <>
@@ -0,0 +1,79 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_PASSPORT_TRACING_H_
+#define MAIDSAFE_PASSPORT_TRACING_H_
+
+#include <chrono>
+
+#include "boost/filesystem/path.hpp"
+
+#include "maidsafe/common/data_types/data_type_values.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+enum class Operation;  // Defined in metrics.h.
+
+// While tracing, the library records a begin/end event (with the calling thread and, where
+// applicable, the fob type) around each of its expensive steps: key generation, signing and
+// validating fobs, fob encryption and decryption, PublicFob parsing, and passport serialisation.
+// 'StopTracing' writes these to 'path' in the Chrome trace event format, which can be loaded into
+// chrome://tracing or https://ui.perfetto.dev to view them as a timeline.
+//
+// Calling 'StartTracing' while already tracing discards the events recorded so far.  Each thread
+// keeps at most 65536 events per trace; any beyond that are dropped and their number is logged.
+void StartTracing();
+bool TracingEnabled();
+// Returns false if tracing wasn't started or the file couldn't be written.  Either way, tracing is
+// stopped and the recorded events are discarded.
+bool StopTracing(const boost::filesystem::path& path);
+
+namespace detail {
+
+// Records one trace event spanning its lifetime, if tracing was enabled at construction.  While
+// tracing is disabled, construction costs a single relaxed atomic load: the event is only named
+// (and the clock only read) once tracing is known to be enabled.
+class ScopedTraceEvent {
+ public:
+  // 'name' must be a string literal or otherwise outlive the trace.
+  explicit ScopedTraceEvent(const char* name);
+  // Named after 'operation' (see OperationName) and, if given, labelled with the fob type.
+  explicit ScopedTraceEvent(Operation operation);
+  ScopedTraceEvent(Operation operation, DataTagValue fob_type);
+  ~ScopedTraceEvent();
+
+ private:
+  ScopedTraceEvent(const ScopedTraceEvent&) = delete;
+  ScopedTraceEvent(ScopedTraceEvent&&) = delete;
+  ScopedTraceEvent& operator=(ScopedTraceEvent) = delete;
+
+  const unsigned session_;  // 0 if tracing wasn't enabled at construction.
+  const char* name_;
+  const char* fob_type_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace detail
+
+}  // namespace passport
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_PASSPORT_TRACING_H_
@@ -25,6 +25,7 @@
 #include "maidsafe/passport/detail/config.h"
 #include "maidsafe/passport/detail/fob.h"
 #include "maidsafe/passport/detail/public_fob.h"
+#include "maidsafe/passport/detail/public_fob_cache.h"
 
 namespace maidsafe {
 
@@ -72,6 +73,19 @@ using PublicPmid = detail::PublicFob<detail::PmidTag>;
 using PublicAnmpid = detail::PublicFob<detail::AnmpidTag>;
 using PublicMpid = detail::PublicFob<detail::MpidTag>;
 
+// Enables caching of up to 'capacity' parsed and validated public keys of the given type (e.g.
+// PublicPmid), so that repeatedly parsing the same serialised key doesn't repeat the signature
+// check.  A capacity of 0 (the default) disables the cache.
+template <typename PublicKeyType>
+void SetPublicKeyCacheCapacity(std::size_t capacity) {
+  detail::PublicFobCache<typename PublicKeyType::Tag>::Instance().SetCapacity(capacity);
+}
+
+template <typename PublicKeyType>
+detail::PublicFobCacheStats GetPublicKeyCacheStats() {
+  return detail::PublicFobCache<typename PublicKeyType::Tag>::Instance().GetStats();
+}
+
 // Public key type traits.
 template <typename T>
 struct is_public_key_type : public std::false_type {};
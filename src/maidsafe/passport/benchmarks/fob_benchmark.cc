@@ -0,0 +1,174 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/passport/detail/fob.h"
+
+#include <string>
+#include <type_traits>
+
+#include "benchmark/benchmark.h"
+
+#include "maidsafe/common/crypto.h"
+#include "maidsafe/common/rsa.h"
+#include "maidsafe/common/utils.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace benchmarks {
+
+namespace {
+
+template <typename TagType>
+detail::Fob<TagType> CreateFob(std::true_type /*self_signed*/) {
+  return detail::Fob<TagType>();
+}
+
+template <typename TagType>
+detail::Fob<TagType> CreateFob(std::false_type /*self_signed*/) {
+  typename detail::Fob<TagType>::Signer signer;
+  return detail::Fob<TagType>(signer);
+}
+
+template <typename TagType>
+detail::Fob<TagType> CreateFob() {
+  return CreateFob<TagType>(typename detail::is_self_signed<TagType>::type());
+}
+
+// Self-signed fobs
+template <typename TagType>
+void GenerateFobs(benchmark::State& state, std::true_type /*self_signed*/) {
+  for (auto _ : state)
+    benchmark::DoNotOptimize(detail::Fob<TagType>());
+}
+
+// Non-self-signed fobs.  The signer is created once, outside the timed loop.
+template <typename TagType>
+void GenerateFobs(benchmark::State& state, std::false_type /*self_signed*/) {
+  typename detail::Fob<TagType>::Signer signer;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(detail::Fob<TagType>(signer));
+}
+
+}  // unnamed namespace
+
+// Dominated by RSA key pair generation, so expect a wide spread between runs.
+template <typename TagType>
+void BM_GenerateFob(benchmark::State& state) {
+  GenerateFobs<TagType>(state, typename detail::is_self_signed<TagType>::type());
+}
+BENCHMARK_TEMPLATE(BM_GenerateFob, detail::AnmaidTag)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_GenerateFob, detail::MaidTag)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_GenerateFob, detail::AnpmidTag)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_GenerateFob, detail::PmidTag)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_GenerateFob, detail::AnmpidTag)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_GenerateFob, detail::MpidTag)->Unit(benchmark::kMillisecond);
+
+template <typename TagType>
+void BM_FobEncrypt(benchmark::State& state) {
+  detail::Fob<TagType> fob(CreateFob<TagType>());
+  crypto::AES256Key symm_key(RandomString(crypto::AES256_KeySize));
+  crypto::AES256InitialisationVector symm_iv(RandomString(crypto::AES256_IVSize));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(fob.Encrypt(symm_key, symm_iv));
+}
+BENCHMARK_TEMPLATE(BM_FobEncrypt, detail::AnmaidTag);
+BENCHMARK_TEMPLATE(BM_FobEncrypt, detail::MaidTag);
+BENCHMARK_TEMPLATE(BM_FobEncrypt, detail::AnpmidTag);
+BENCHMARK_TEMPLATE(BM_FobEncrypt, detail::PmidTag);
+BENCHMARK_TEMPLATE(BM_FobEncrypt, detail::AnmpidTag);
+BENCHMARK_TEMPLATE(BM_FobEncrypt, detail::MpidTag);
+
+// Decrypting includes the full validation of the fob (signature check, key match and name).
+template <typename TagType>
+void BM_FobDecrypt(benchmark::State& state) {
+  crypto::AES256Key symm_key(RandomString(crypto::AES256_KeySize));
+  crypto::AES256InitialisationVector symm_iv(RandomString(crypto::AES256_IVSize));
+  crypto::CipherText encrypted_fob(CreateFob<TagType>().Encrypt(symm_key, symm_iv));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(detail::Fob<TagType>(encrypted_fob, symm_key, symm_iv));
+}
+BENCHMARK_TEMPLATE(BM_FobDecrypt, detail::AnmaidTag);
+BENCHMARK_TEMPLATE(BM_FobDecrypt, detail::MaidTag);
+BENCHMARK_TEMPLATE(BM_FobDecrypt, detail::AnpmidTag);
+BENCHMARK_TEMPLATE(BM_FobDecrypt, detail::PmidTag);
+BENCHMARK_TEMPLATE(BM_FobDecrypt, detail::AnmpidTag);
+BENCHMARK_TEMPLATE(BM_FobDecrypt, detail::MpidTag);
+
+// The signature policy primitives in isolation, for a range of key sizes (see detail::KeySize).
+// These are templated on the policy so that any alternative scheme can be compared against
+// RsaPssPolicy by registering it here too.
+void KeySizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgName("bits");
+  for (int key_bits : {1536, 2048, 3072, 4096})
+    benchmark->Arg(key_bits);
+}
+
+template <typename Policy>
+void BM_PolicyGenerateKeyPair(benchmark::State& state) {
+  for (auto _ : state)
+    benchmark::DoNotOptimize(Policy::GenerateKeyPair(static_cast<unsigned>(state.range(0))));
+}
+BENCHMARK_TEMPLATE(BM_PolicyGenerateKeyPair, detail::RsaPssPolicy)
+    ->Apply(KeySizes)
+    ->Unit(benchmark::kMillisecond);
+
+template <typename Policy>
+void BM_PolicySign(benchmark::State& state) {
+  typename Policy::Keys keys(Policy::GenerateKeyPair(static_cast<unsigned>(state.range(0))));
+  asymm::PlainText data(RandomString(64));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(Policy::Sign(data, keys.private_key));
+}
+BENCHMARK_TEMPLATE(BM_PolicySign, detail::RsaPssPolicy)->Apply(KeySizes);
+
+template <typename Policy>
+void BM_PolicyCheckSignature(benchmark::State& state) {
+  typename Policy::Keys keys(Policy::GenerateKeyPair(static_cast<unsigned>(state.range(0))));
+  asymm::PlainText data(RandomString(64));
+  typename Policy::Signature signature(Policy::Sign(data, keys.private_key));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(Policy::CheckSignature(data, signature, keys.public_key));
+}
+BENCHMARK_TEMPLATE(BM_PolicyCheckSignature, detail::RsaPssPolicy)->Apply(KeySizes);
+
+// Checks that a private key matches its public key the way Fob::ValidateToken used to: by
+// encrypting a random string with the public key and decrypting it with the private one.
+void BM_KeysMatchByRoundTrip(benchmark::State& state) {
+  asymm::Keys keys(asymm::GenerateKeyPair());
+  for (auto _ : state) {
+    asymm::PlainText plain(RandomString((RandomUint32() % 100) + 100));
+    benchmark::DoNotOptimize(asymm::Decrypt(asymm::Encrypt(plain, keys.public_key),
+                                            keys.private_key) == plain);
+  }
+}
+BENCHMARK(BM_KeysMatchByRoundTrip);
+
+void BM_KeysMatch(benchmark::State& state) {
+  asymm::Keys keys(asymm::GenerateKeyPair());
+  for (auto _ : state)
+    benchmark::DoNotOptimize(detail::RsaPssPolicy::KeysMatch(keys));
+}
+BENCHMARK(BM_KeysMatch);
+
+}  // namespace benchmarks
+
+}  // namespace passport
+
+}  // namespace maidsafe
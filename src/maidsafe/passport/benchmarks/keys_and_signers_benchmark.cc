@@ -0,0 +1,103 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/passport/detail/keys_and_signers.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "maidsafe/passport/tests/stand_in_key.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace benchmarks {
+
+namespace {
+
+using Key = test::StandInKey;
+using KeyAndSigner = test::StandInKeyAndSigner;
+
+std::vector<KeyAndSigner> CreateKeysAndSigners(std::size_t count) {
+  std::vector<KeyAndSigner> keys_and_signers;
+  keys_and_signers.reserve(count);
+  for (std::size_t i(0); i < count; ++i)
+    keys_and_signers.push_back(test::CreateStandInKeyAndSigner());
+  return keys_and_signers;
+}
+
+}  // unnamed namespace
+
+// Adding n keys, checking each for duplicates.  Items per second should stay flat as n grows.
+void BM_KeysAndSignersAdd(benchmark::State& state) {
+  const std::vector<KeyAndSigner> keys_and_signers(
+      CreateKeysAndSigners(static_cast<std::size_t>(state.range(0))));
+  for (auto _ : state) {
+    detail::KeysAndSigners<Key> indexed;
+    for (const auto& key_and_signer : keys_and_signers)
+      indexed.Add(key_and_signer);
+    benchmark::DoNotOptimize(indexed.size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_KeysAndSignersAdd)->RangeMultiplier(10)->Range(10, 100000);
+
+// The linear duplicate check previously used by Passport, for comparison.
+void BM_LinearAdd(benchmark::State& state) {
+  const std::vector<KeyAndSigner> keys_and_signers(
+      CreateKeysAndSigners(static_cast<std::size_t>(state.range(0))));
+  for (auto _ : state) {
+    std::vector<KeyAndSigner> added;
+    for (const auto& key_and_signer : keys_and_signers) {
+      benchmark::DoNotOptimize(
+          std::any_of(std::begin(added), std::end(added), [&](const KeyAndSigner& existing) {
+            return key_and_signer.first.name() == existing.first.name() ||
+                   key_and_signer.second.name() == existing.second.name();
+          }));
+      added.push_back(key_and_signer);
+    }
+    benchmark::DoNotOptimize(added.size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LinearAdd)->RangeMultiplier(10)->Range(10, 10000);
+
+void BM_KeysAndSignersFindAndRemove(benchmark::State& state) {
+  const std::vector<KeyAndSigner> keys_and_signers(
+      CreateKeysAndSigners(static_cast<std::size_t>(state.range(0))));
+  detail::KeysAndSigners<Key> indexed;
+  for (const auto& key_and_signer : keys_and_signers)
+    indexed.Add(key_and_signer);
+  std::size_t index(0);
+  for (auto _ : state) {
+    const KeyAndSigner& key_and_signer(keys_and_signers[index++ % keys_and_signers.size()]);
+    benchmark::DoNotOptimize(indexed.Find(key_and_signer.first.name()));
+    indexed.Remove(key_and_signer.first.name());
+    indexed.Add(key_and_signer);
+  }
+}
+BENCHMARK(BM_KeysAndSignersFindAndRemove)->RangeMultiplier(10)->Range(10, 100000);
+
+}  // namespace benchmarks
+
+}  // namespace passport
+
+}  // namespace maidsafe
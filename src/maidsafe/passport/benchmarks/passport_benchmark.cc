@@ -0,0 +1,151 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/passport/passport.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "maidsafe/common/make_unique.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/passport/detail/parallel.h"
+#include "maidsafe/passport/tests/user_credentials.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace benchmarks {
+
+namespace {
+
+// Key generation dominates the setup of the larger passports, so the pairs are made in parallel.
+std::unique_ptr<Passport> CreatePassport(int pmid_count) {
+  auto passport(maidsafe::make_unique<Passport>(CreateMaidAndSigner()));
+  std::vector<PmidAndSigner> pmids_and_signers;
+  std::mutex mutex;
+  detail::ParallelFor(static_cast<std::size_t>(pmid_count), [&](std::size_t) {
+    PmidAndSigner pmid_and_signer(CreatePmidAndSigner());
+    std::lock_guard<std::mutex> lock(mutex);
+    pmids_and_signers.push_back(std::move(pmid_and_signer));
+  });
+  for (const auto& pmid_and_signer : pmids_and_signers)
+    passport->AddKeyAndSigner(pmid_and_signer);
+  return passport;
+}
+
+}  // unnamed namespace
+
+// Generates two RSA key pairs and signs the Pmid's public key with the Anpmid.
+void BM_CreatePmidAndSigner(benchmark::State& state) {
+  for (auto _ : state)
+    benchmark::DoNotOptimize(CreatePmidAndSigner());
+}
+BENCHMARK(BM_CreatePmidAndSigner)->Unit(benchmark::kMillisecond);
+
+// Alternates between two sessions so that no ciphertext from the previous save can be reused, i.e.
+// every fob in the passport is encrypted on each iteration.
+void BM_PassportEncrypt(benchmark::State& state) {
+  std::unique_ptr<Passport> passport(CreatePassport(static_cast<int>(state.range(0))));
+  PassportSession session0(test::CreateUserCredentials()), session1(test::CreateUserCredentials());
+  bool use_first(true);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(passport->Encrypt(use_first ? session0 : session1));
+    use_first = !use_first;
+  }
+}
+BENCHMARK(BM_PassportEncrypt)
+    ->Arg(1)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Unit(benchmark::kMillisecond);
+
+// Saving an unchanged passport with the same session reuses all the previous fob ciphertexts.
+void BM_PassportReEncrypt(benchmark::State& state) {
+  std::unique_ptr<Passport> passport(CreatePassport(static_cast<int>(state.range(0))));
+  PassportSession session(test::CreateUserCredentials());
+  passport->Encrypt(session);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(passport->Encrypt(session));
+}
+BENCHMARK(BM_PassportReEncrypt)
+    ->Arg(1)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Unit(benchmark::kMillisecond);
+
+// Parsing a passport validates every fob it contains, so its cost grows with the number of keys.
+// As for BM_PassportEncrypt, the session's key material is derived once, outside the timed loop.
+void BM_PassportDecrypt(benchmark::State& state) {
+  PassportSession session(test::CreateUserCredentials());
+  crypto::CipherText encrypted_passport(
+      CreatePassport(static_cast<int>(state.range(0)))->Encrypt(session));
+  for (auto _ : state)
+    Passport passport(encrypted_passport, session);
+}
+BENCHMARK(BM_PassportDecrypt)
+    ->Arg(1)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Unit(benchmark::kMillisecond);
+
+// Many threads reading from one passport.  Readers share the lock, so throughput should scale with
+// the thread count.
+void BM_PassportConcurrentReads(benchmark::State& state) {
+  static std::unique_ptr<Passport> passport(CreatePassport(10));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(passport->GetMaid());
+    benchmark::DoNotOptimize(passport->GetPmids());
+  }
+}
+BENCHMARK(BM_PassportConcurrentReads)->ThreadRange(1, 16)->UseRealTime();
+
+// Repeatedly adds a Pmid, saves, then removes that Pmid, to a passport already holding
+// 'state.range(0)' Pmids.  Only the added Pmid and the Maid need encrypting on each save, so the cost
+// per iteration should barely grow with the size of the passport.
+void BM_PassportAddThenSave(benchmark::State& state) {
+  std::unique_ptr<Passport> passport(CreatePassport(static_cast<int>(state.range(0))));
+  PassportSession session(test::CreateUserCredentials());
+  passport->Encrypt(session);
+  // Cycling through more than one pair means each is evicted from the passport's ciphertext cache
+  // before it's added again.
+  std::vector<PmidAndSigner> pmids_and_signers;
+  for (int i(0); i < 4; ++i)
+    pmids_and_signers.push_back(CreatePmidAndSigner());
+  std::size_t index(0);
+  for (auto _ : state) {
+    const PmidAndSigner& pmid_and_signer(pmids_and_signers[index++ % pmids_and_signers.size()]);
+    passport->AddKeyAndSigner(pmid_and_signer);
+    benchmark::DoNotOptimize(passport->Encrypt(session));
+    passport->RemoveKeyAndSigner(pmid_and_signer.first);
+  }
+}
+BENCHMARK(BM_PassportAddThenSave)->Arg(1)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+
+}  // namespace benchmarks
+
+}  // namespace passport
+
+}  // namespace maidsafe
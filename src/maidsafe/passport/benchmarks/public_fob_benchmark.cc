@@ -0,0 +1,68 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/passport/detail/public_fob.h"
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+#include "maidsafe/passport/types.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace benchmarks {
+
+// The first Serialise() of a fob does the work; each iteration uses a new PublicPmid (sharing the
+// same key) so the result isn't simply the memoised one.
+void BM_PublicFobSerialise(benchmark::State& state) {
+  Pmid::Signer anpmid;
+  Pmid pmid(anpmid);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(PublicPmid(pmid).Serialise());
+}
+BENCHMARK(BM_PublicFobSerialise);
+
+void BM_PublicFobSerialiseMemoised(benchmark::State& state) {
+  Pmid::Signer anpmid;
+  PublicPmid public_pmid{Pmid(anpmid)};
+  for (auto _ : state)
+    benchmark::DoNotOptimize(public_pmid.Serialise());
+}
+BENCHMARK(BM_PublicFobSerialiseMemoised);
+
+// Parsing decodes the public key and verifies the fob's validation token.  With the cache enabled
+// (state.range(0) == 1), every parse after the first is a cache hit.
+void BM_PublicFobParse(benchmark::State& state) {
+  Pmid::Signer anpmid;
+  PublicPmid public_pmid{Pmid(anpmid)};
+  const PublicPmid::serialised_type serialised(public_pmid.Serialise());
+  SetPublicKeyCacheCapacity<PublicPmid>(state.range(0) == 0 ? 0 : 16);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(PublicPmid(public_pmid.name(), serialised));
+  SetPublicKeyCacheCapacity<PublicPmid>(0);
+}
+BENCHMARK(BM_PublicFobParse)->Arg(0)->Arg(1);
+
+}  // namespace benchmarks
+
+}  // namespace passport
+
+}  // namespace maidsafe
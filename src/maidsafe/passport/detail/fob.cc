@@ -18,77 +18,417 @@
 
 #include "maidsafe/passport/detail/fob.h"
 
+#include <cstring>
+#include <mutex>
+
+#include "boost/filesystem/fstream.hpp"
+#include "boost/filesystem/operations.hpp"
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
+#include "cryptopp/integer.h"
+#include "cryptopp/nbtheory.h"
+#include "cryptopp/rsa.h"
+
+#include "maidsafe/common/log.h"
 #include "maidsafe/common/utils.h"
 
+#include "maidsafe/passport/detail/parallel.h"
+
 namespace maidsafe {
 
 namespace passport {
 
 namespace detail {
 
-asymm::PlainText GetRandomString() {
-  return asymm::PlainText(RandomString((RandomUint32() % 100) + 100));
+bool RsaPssPolicy::KeysMatch(const Keys& keys) {
+  using CryptoPP::Integer;
+  const Integer& modulus(keys.public_key.GetModulus());
+  const Integer& public_exponent(keys.public_key.GetPublicExponent());
+  if (keys.private_key.GetModulus() != modulus ||
+      keys.private_key.GetPublicExponent() != public_exponent) {
+    return false;
+  }
+  // Check the private key's components are consistent with the modulus and public exponent, i.e.
+  // n == p * q, e * d == 1 mod lcm(p - 1, q - 1), and that the CRT values used for decryption are
+  // derived from these.
+  const Integer& p(keys.private_key.GetPrime1());
+  const Integer& q(keys.private_key.GetPrime2());
+  const Integer& d(keys.private_key.GetPrivateExponent());
+  if (p <= Integer::One() || q <= Integer::One() || p * q != modulus)
+    return false;
+  const Integer p_minus_one(p - Integer::One()), q_minus_one(q - Integer::One());
+  return (public_exponent * d) % CryptoPP::LCM(p_minus_one, q_minus_one) == Integer::One() &&
+         keys.private_key.GetModPrime1PrivateExponent() == d % p_minus_one &&
+         keys.private_key.GetModPrime2PrivateExponent() == d % q_minus_one &&
+         (q * keys.private_key.GetMultiplicativeInverseOfPrime2ModPrime1()) % p == Integer::One();
+}
+
+RsaPssPolicy::Keys RsaPssPolicy::GenerateKeyPair(unsigned key_bits) {
+  CryptoPP::InvertibleRSAFunction parameters;
+  parameters.GenerateRandomWithKeySize(crypto::random_number_generator(), key_bits);
+  Keys keys;
+  keys.private_key = PrivateKey(parameters);
+  keys.public_key = PublicKey(parameters);
+  return keys;
 }
 
 #ifdef TESTING
 
+namespace {
+
+// Versioned key list file layout (all integers little-endian):
+//   header:  8-byte magic, uint32 version, uint32 entry kind, uint64 entry count, uint64 table offset
+//   entries: for each fob in the entry, a uint32 size followed by that many bytes of ciphertext
+//   table:   a uint64 file offset for the start of each entry, in order
+// The table is written last so that entries can be streamed out as they are produced.
+const char kKeyListMagic[] = {'M', 'S', 'K', 'E', 'Y', 'L', 'S', 'T'};
+const std::uint32_t kKeyListVersion = 1;
+const std::size_t kKeyListHeaderSize = sizeof(kKeyListMagic) + 4 + 4 + 8 + 8;
+
+crypto::AES256Key KeyListSymmKey() {
+  return crypto::AES256Key(std::string(crypto::AES256_KeySize, 0));
+}
+
+crypto::AES256InitialisationVector KeyListSymmIv() {
+  return crypto::AES256InitialisationVector(std::string(crypto::AES256_IVSize, 0));
+}
+
+template <typename Entry>
+struct KeyListEntry;
+
+template <>
+struct KeyListEntry<AnmaidToPmid> {
+  enum : std::uint32_t { kKind = 1 };
+  enum : std::size_t { kFobCount = 4 };
+
+  static std::vector<crypto::CipherText> Encrypt(const AnmaidToPmid& keychain) {
+    const crypto::AES256Key symm_key(KeyListSymmKey());
+    const crypto::AES256InitialisationVector symm_iv(KeyListSymmIv());
+    std::vector<crypto::CipherText> encrypted;
+    encrypted.reserve(kFobCount);
+    encrypted.emplace_back(keychain.anmaid.Encrypt(symm_key, symm_iv));
+    encrypted.emplace_back(keychain.maid.Encrypt(symm_key, symm_iv));
+    encrypted.emplace_back(keychain.anpmid.Encrypt(symm_key, symm_iv));
+    encrypted.emplace_back(keychain.pmid.Encrypt(symm_key, symm_iv));
+    return encrypted;
+  }
+
+  static AnmaidToPmid Decrypt(const std::vector<crypto::CipherText>& encrypted) {
+    const crypto::AES256Key symm_key(KeyListSymmKey());
+    const crypto::AES256InitialisationVector symm_iv(KeyListSymmIv());
+    return AnmaidToPmid(Fob<AnmaidTag>(encrypted[0], symm_key, symm_iv),
+                        Fob<MaidTag>(encrypted[1], symm_key, symm_iv),
+                        Fob<AnpmidTag>(encrypted[2], symm_key, symm_iv),
+                        Fob<PmidTag>(encrypted[3], symm_key, symm_iv));
+  }
+};
+
+template <>
+struct KeyListEntry<Fob<PmidTag>> {
+  enum : std::uint32_t { kKind = 2 };
+  enum : std::size_t { kFobCount = 1 };
+
+  static std::vector<crypto::CipherText> Encrypt(const Fob<PmidTag>& pmid) {
+    std::vector<crypto::CipherText> encrypted;
+    encrypted.emplace_back(pmid.Encrypt(KeyListSymmKey(), KeyListSymmIv()));
+    return encrypted;
+  }
+
+  static Fob<PmidTag> Decrypt(const std::vector<crypto::CipherText>& encrypted) {
+    return Fob<PmidTag>(encrypted[0], KeyListSymmKey(), KeyListSymmIv());
+  }
+};
+
+void AppendUint32(std::uint32_t value, std::string& output) {
+  for (int i(0); i < 4; ++i)
+    output.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+void AppendUint64(std::uint64_t value, std::string& output) {
+  for (int i(0); i < 8; ++i)
+    output.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+std::uint32_t ReadUint32(const byte* input) {
+  std::uint32_t value(0);
+  for (int i(0); i < 4; ++i)
+    value |= static_cast<std::uint32_t>(input[i]) << (8 * i);
+  return value;
+}
+
+std::uint64_t ReadUint64(const byte* input) {
+  std::uint64_t value(0);
+  for (int i(0); i < 8; ++i)
+    value |= static_cast<std::uint64_t>(input[i]) << (8 * i);
+  return value;
+}
+
+std::string EncodeKeyListHeader(std::uint32_t kind, std::uint64_t count,
+                                std::uint64_t table_offset) {
+  std::string header(kKeyListMagic, sizeof(kKeyListMagic));
+  AppendUint32(kKeyListVersion, header);
+  AppendUint32(kind, header);
+  AppendUint64(count, header);
+  AppendUint64(table_offset, header);
+  return header;
+}
+
+template <typename Entry>
+std::string EncodeKeyListEntry(const Entry& entry) {
+  std::string encoded;
+  for (const auto& encrypted_fob : KeyListEntry<Entry>::Encrypt(entry)) {
+    const std::string& ciphertext(encrypted_fob->string());
+    AppendUint32(static_cast<std::uint32_t>(ciphertext.size()), encoded);
+    encoded += ciphertext;
+  }
+  return encoded;
+}
+
+// Streams encoded entries to a file in the versioned key list format.  Output is staged in a buffer of
+// at most 'kBufferSize' bytes, so memory use doesn't depend on the size of the entries written; only
+// the offset table (8 bytes per entry) is held until 'Finish' writes it and patches the header.
+// Throws std::ios_base::failure on any write error.
+class KeyListWriter {
+ public:
+  KeyListWriter(const boost::filesystem::path& file_path, std::uint32_t kind)
+      : file_(), kind_(kind), buffer_(), offsets_(), position_(0) {
+    file_.exceptions(std::ios::failbit | std::ios::badbit);
+    file_.open(file_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    buffer_.reserve(kBufferSize);
+    // The count and table offset aren't known yet, so the header is rewritten by 'Finish'.
+    Write(EncodeKeyListHeader(kind_, 0, 0));
+  }
+
+  void Append(const std::string& encoded_entry) {
+    offsets_.push_back(position_);
+    Write(encoded_entry);
+  }
+
+  void Finish() {
+    const std::uint64_t table_offset(position_);
+    std::string encoded_offset;
+    for (std::uint64_t offset : offsets_) {
+      encoded_offset.clear();
+      AppendUint64(offset, encoded_offset);
+      Write(encoded_offset);
+    }
+    Flush();
+    const std::string header(EncodeKeyListHeader(kind_, offsets_.size(), table_offset));
+    file_.seekp(0);
+    file_.write(header.data(), header.size());
+    file_.close();
+  }
+
+ private:
+  KeyListWriter(const KeyListWriter&) = delete;
+  KeyListWriter& operator=(const KeyListWriter&) = delete;
+
+  static const std::size_t kBufferSize = 64 * 1024;
+
+  void Write(const std::string& data) {
+    if (buffer_.size() + data.size() > kBufferSize)
+      Flush();
+    if (data.size() > kBufferSize)
+      file_.write(data.data(), data.size());
+    else
+      buffer_ += data;
+    position_ += data.size();
+  }
+
+  void Flush() {
+    file_.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+
+  boost::filesystem::ofstream file_;
+  const std::uint32_t kind_;
+  std::string buffer_;
+  std::vector<std::uint64_t> offsets_;
+  std::uint64_t position_;
+};
+
+template <typename Entry>
+bool WriteKeyList(const boost::filesystem::path& file_path, const std::vector<Entry>& entries) {
+  try {
+    KeyListWriter writer(file_path, KeyListEntry<Entry>::kKind);
+    for (const auto& entry : entries)
+      writer.Append(EncodeKeyListEntry(entry));
+    writer.Finish();
+    return true;
+  } catch (const std::exception& e) {
+    LOG(kError) << "Failed to write " << file_path << ": " << e.what();
+    return false;
+  }
+}
+
+}  // unnamed namespace
+
+template <typename Entry>
+struct KeyListReader<Entry>::Impl {
+  Impl() : mapping(), region(), data(nullptr), count(0), table_offset(0), legacy_entries() {}
+
+  boost::interprocess::file_mapping mapping;
+  boost::interprocess::mapped_region region;
+  const byte* data;
+  std::uint64_t count, table_offset;
+  // Only used for files in the unversioned format; holds 'count' * kFobCount encrypted fobs.
+  std::vector<crypto::CipherText> legacy_entries;
+};
+
+template <typename Entry>
+KeyListReader<Entry>::KeyListReader(const boost::filesystem::path& file_path)
+    : impl_(new Impl) {
+  namespace bip = boost::interprocess;
+  const std::uintmax_t file_size(boost::filesystem::file_size(file_path));
+  if (file_size >= kKeyListHeaderSize) {
+    try {
+      bip::file_mapping mapping(file_path.string().c_str(), bip::read_only);
+      bip::mapped_region region(mapping, bip::read_only);
+      impl_->mapping.swap(mapping);
+      impl_->region.swap(region);
+    } catch (const bip::interprocess_exception& e) {
+      LOG(kError) << "Failed to map " << file_path << ": " << e.what();
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+    }
+    impl_->data = static_cast<const byte*>(impl_->region.get_address());
+  }
+
+  if (!impl_->data || std::memcmp(impl_->data, kKeyListMagic, sizeof(kKeyListMagic)) != 0) {
+    // Unversioned format: a serialised uint32 count followed by serialised CipherTexts.
+    bip::mapped_region().swap(impl_->region);
+    bip::file_mapping().swap(impl_->mapping);
+    impl_->data = nullptr;
+    std::string contents(ReadFile(file_path).string());
+    InputVectorStream binary_input_stream(SerialisedData(contents.begin(), contents.end()));
+    impl_->count = Parse<std::uint32_t>(binary_input_stream);
+    const std::size_t fob_count(static_cast<std::size_t>(impl_->count) *
+                                KeyListEntry<Entry>::kFobCount);
+    impl_->legacy_entries.reserve(fob_count);
+    for (std::size_t i(0); i < fob_count; ++i)
+      impl_->legacy_entries.emplace_back(Parse<crypto::CipherText>(binary_input_stream));
+    return;
+  }
+
+  const byte* header(impl_->data + sizeof(kKeyListMagic));
+  const std::uint32_t version(ReadUint32(header));
+  const std::uint32_t kind(ReadUint32(header + 4));
+  impl_->count = ReadUint64(header + 8);
+  impl_->table_offset = ReadUint64(header + 16);
+  if (version != kKeyListVersion) {
+    LOG(kError) << file_path << " has unsupported version " << version;
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  }
+  if (kind != KeyListEntry<Entry>::kKind || impl_->table_offset < kKeyListHeaderSize ||
+      impl_->table_offset > file_size || (file_size - impl_->table_offset) / 8 != impl_->count ||
+      (file_size - impl_->table_offset) % 8 != 0) {
+    LOG(kError) << file_path << " is not a valid key list of the requested type";
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  }
+}
+
+template <typename Entry>
+KeyListReader<Entry>::~KeyListReader() {}
+
+template <typename Entry>
+KeyListReader<Entry>::KeyListReader(KeyListReader&& other)
+    : impl_(std::move(other.impl_)) {}
+
+template <typename Entry>
+KeyListReader<Entry>& KeyListReader<Entry>::operator=(KeyListReader other) {
+  swap(*this, other);
+  return *this;
+}
+
+template <typename Entry>
+std::size_t KeyListReader<Entry>::size() const {
+  return static_cast<std::size_t>(impl_->count);
+}
+
+template <typename Entry>
+Entry KeyListReader<Entry>::Get(std::size_t index) const {
+  if (index >= size())
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+  const std::size_t fob_count(KeyListEntry<Entry>::kFobCount);
+  if (!impl_->data) {
+    auto first(std::begin(impl_->legacy_entries) + index * fob_count);
+    return KeyListEntry<Entry>::Decrypt(std::vector<crypto::CipherText>(first, first + fob_count));
+  }
+
+  const byte* table(impl_->data + impl_->table_offset);
+  const std::uint64_t begin_offset(ReadUint64(table + 8 * index));
+  const std::uint64_t end_offset(index + 1 == size() ? impl_->table_offset
+                                                      : ReadUint64(table + 8 * (index + 1)));
+  if (begin_offset < kKeyListHeaderSize || begin_offset > end_offset ||
+      end_offset > impl_->table_offset) {
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  }
+  const byte* position(impl_->data + begin_offset);
+  const byte* const end(impl_->data + end_offset);
+  std::vector<crypto::CipherText> encrypted;
+  encrypted.reserve(fob_count);
+  for (std::size_t i(0); i < fob_count; ++i) {
+    if (end - position < 4)
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+    const std::uint32_t ciphertext_size(ReadUint32(position));
+    position += 4;
+    if (static_cast<std::uint64_t>(end - position) < ciphertext_size)
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+    encrypted.emplace_back(NonEmptyString(
+        std::string(reinterpret_cast<const char*>(position), ciphertext_size)));
+    position += ciphertext_size;
+  }
+  if (position != end)
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  return KeyListEntry<Entry>::Decrypt(encrypted);
+}
+
+template class KeyListReader<Fob<PmidTag>>;
+template class KeyListReader<AnmaidToPmid>;
+
 std::vector<Fob<PmidTag>> ReadPmidList(const boost::filesystem::path& file_path) {
-  std::string contents(ReadFile(file_path).string());
-  InputVectorStream binary_input_stream(SerialisedData(contents.begin(), contents.end()));
-  std::uint32_t pmid_list_size(Parse<std::uint32_t>(binary_input_stream));
+  PmidListReader reader(file_path);
   std::vector<Fob<PmidTag>> pmid_list;
-  crypto::AES256Key symm_key(std::string(crypto::AES256_KeySize, 0));
-  crypto::AES256InitialisationVector symm_iv(std::string(crypto::AES256_IVSize, 0));
-  for (std::uint32_t i = 0; i < pmid_list_size; ++i)
-    pmid_list.emplace_back(Parse<crypto::CipherText>(binary_input_stream), symm_key, symm_iv);
+  pmid_list.reserve(reader.size());
+  for (std::size_t i(0); i < reader.size(); ++i)
+    pmid_list.emplace_back(reader.Get(i));
   return pmid_list;
 }
 
 bool WritePmidList(const boost::filesystem::path& file_path,
                    const std::vector<Fob<PmidTag>>& pmid_list) {
-  OutputVectorStream binary_output_stream;
-  Serialise(binary_output_stream, static_cast<std::uint32_t>(pmid_list.size()));
-  crypto::AES256Key symm_key(std::string(crypto::AES256_KeySize, 0));
-  crypto::AES256InitialisationVector symm_iv(std::string(crypto::AES256_IVSize, 0));
-  for (const auto& pmid : pmid_list)
-    Serialise(binary_output_stream, pmid.Encrypt(symm_key, symm_iv));
-  SerialisedData contents(binary_output_stream.vector());
-  return WriteFile(file_path, std::string(contents.begin(), contents.end()));
+  return WriteKeyList(file_path, pmid_list);
 }
 
 std::vector<AnmaidToPmid> ReadKeyChainList(const boost::filesystem::path& file_path) {
-  std::string contents(ReadFile(file_path).string());
-  InputVectorStream binary_input_stream(SerialisedData(contents.begin(), contents.end()));
-  std::uint32_t keychain_list_size(Parse<std::uint32_t>(binary_input_stream));
+  KeyChainListReader reader(file_path);
   std::vector<AnmaidToPmid> keychain_list;
-  crypto::AES256Key symm_key(std::string(crypto::AES256_KeySize, 0));
-  crypto::AES256InitialisationVector symm_iv(std::string(crypto::AES256_IVSize, 0));
-  for (std::uint32_t i = 0; i < keychain_list_size; ++i) {
-    crypto::CipherText encrypted_anmaid(Parse<crypto::CipherText>(binary_input_stream));
-    crypto::CipherText encrypted_maid(Parse<crypto::CipherText>(binary_input_stream));
-    crypto::CipherText encrypted_anpmid(Parse<crypto::CipherText>(binary_input_stream));
-    crypto::CipherText encrypted_pmid(Parse<crypto::CipherText>(binary_input_stream));
-    keychain_list.emplace_back(Anmaid(std::move(encrypted_anmaid), symm_key, symm_iv),
-                               Maid(std::move(encrypted_maid), symm_key, symm_iv),
-                               Anpmid(std::move(encrypted_anpmid), symm_key, symm_iv),
-                               Pmid(std::move(encrypted_pmid), symm_key, symm_iv));
-  }
+  keychain_list.reserve(reader.size());
+  for (std::size_t i(0); i < reader.size(); ++i)
+    keychain_list.emplace_back(reader.Get(i));
   return keychain_list;
 }
 
 bool WriteKeyChainList(const boost::filesystem::path& file_path,
                        const std::vector<AnmaidToPmid>& keychain_list) {
-  OutputVectorStream binary_output_stream;
-  Serialise(binary_output_stream, static_cast<std::uint32_t>(keychain_list.size()));
-  crypto::AES256Key symm_key(std::string(crypto::AES256_KeySize, 0));
-  crypto::AES256InitialisationVector symm_iv(std::string(crypto::AES256_IVSize, 0));
-  for (const auto& keychain : keychain_list) {
-    Serialise(binary_output_stream, keychain.anmaid.Encrypt(symm_key, symm_iv),
-              keychain.maid.Encrypt(symm_key, symm_iv), keychain.anpmid.Encrypt(symm_key, symm_iv),
-              keychain.pmid.Encrypt(symm_key, symm_iv));
-  }
-  SerialisedData contents(binary_output_stream.vector());
-  return WriteFile(file_path, std::string(contents.begin(), contents.end()));
+  return WriteKeyList(file_path, keychain_list);
+}
+
+bool GenerateKeyChains(const boost::filesystem::path& file_path, std::size_t count,
+                       std::size_t thread_count) {
+  try {
+    KeyListWriter writer(file_path, KeyListEntry<AnmaidToPmid>::kKind);
+    std::mutex writer_mutex;
+    ParallelFor(count, [&](std::size_t) {
+      std::string entry(EncodeKeyListEntry(AnmaidToPmid()));
+      std::lock_guard<std::mutex> lock(writer_mutex);
+      writer.Append(entry);
+    }, thread_count);
+    writer.Finish();
+    return true;
+  } catch (const std::exception& e) {
+    LOG(kError) << "Failed to generate keychains: " << e.what();
+    return false;
+  }
 }
 
 template <>
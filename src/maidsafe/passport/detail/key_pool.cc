@@ -0,0 +1,154 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/passport/key_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "maidsafe/common/error.h"
+#include "maidsafe/common/log.h"
+
+#include "maidsafe/passport/metrics.h"
+#include "maidsafe/passport/detail/signature_policy.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace {
+
+// The delay before a worker retries after a failed key generation doubles with each consecutive
+// failure, between these bounds.
+const std::chrono::milliseconds kMinRetryDelay(100);
+const std::chrono::milliseconds kMaxRetryDelay(30000);
+
+asymm::Keys GenerateKeyPair(unsigned key_bits) {
+  detail::ScopedTimer timer(Operation::kKeyGeneration);
+  return detail::RsaPssPolicy::GenerateKeyPair(key_bits);
+}
+
+}  // unnamed namespace
+
+KeyPool::KeyPool(std::size_t depth, std::size_t worker_count, unsigned key_bits)
+    : depth_(depth),
+      key_bits_(key_bits),
+      keys_(),
+      pending_(0),
+      hits_(0),
+      misses_(0),
+      failures_(0),
+      stopped_(false),
+      mutex_(),
+      condition_(),
+      workers_() {
+  if (depth_ == 0 || worker_count == 0) {
+    LOG(kError) << "KeyPool requires a non-zero depth and worker count.";
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+  }
+  if (key_bits_ < detail::RsaPssPolicy::kMinimumKeyBits) {
+    LOG(kError) << "KeyPool requires keys of at least " << detail::RsaPssPolicy::kMinimumKeyBits
+                << " bits.";
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+  }
+  try {
+    for (std::size_t i(0); i < worker_count; ++i)
+      workers_.emplace_back([this] { Run(); });
+  } catch (...) {
+    // Any workers already started must be joined before 'workers_' is destroyed.
+    Stop();
+    throw;
+  }
+}
+
+KeyPool::~KeyPool() { Stop(); }
+
+asymm::Keys KeyPool::Get() { return Get(key_bits_); }
+
+asymm::Keys KeyPool::Get(unsigned key_bits) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (key_bits == key_bits_ && !keys_.empty()) {
+      asymm::Keys keys(std::move(keys_.front()));
+      keys_.pop_front();
+      ++hits_;
+      condition_.notify_one();
+      return keys;
+    }
+    ++misses_;
+  }
+  return GenerateKeyPair(key_bits);
+}
+
+KeyPool::Stats KeyPool::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.failures = failures_;
+  stats.available = keys_.size();
+  return stats;
+}
+
+void KeyPool::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  condition_.notify_all();
+  for (auto& worker : workers_)
+    worker.join();
+}
+
+void KeyPool::Run() {
+  std::chrono::milliseconds retry_delay(0);
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this] { return stopped_ || keys_.size() + pending_ < depth_; });
+      if (stopped_)
+        return;
+      ++pending_;
+    }
+    // Generate outside the lock so that 'Get' is never blocked behind key generation.  'pending_'
+    // is only decremented once nothing else in the try block can throw, so that the catch block
+    // never decrements it a second time.
+    try {
+      asymm::Keys keys(GenerateKeyPair(key_bits_));
+      std::lock_guard<std::mutex> lock(mutex_);
+      keys_.push_back(std::move(keys));
+      --pending_;
+      retry_delay = std::chrono::milliseconds(0);
+    } catch (const std::exception& e) {
+      retry_delay = std::min(std::max(2 * retry_delay, kMinRetryDelay), kMaxRetryDelay);
+      LOG(kError) << "Failed to generate key pair for KeyPool: " << e.what() << "  Retrying in "
+                  << retry_delay.count() << " ms.";
+      std::unique_lock<std::mutex> lock(mutex_);
+      --pending_;
+      ++failures_;
+      // Wakes early if the pool is being destroyed.
+      if (condition_.wait_for(lock, retry_delay, [this] { return stopped_; }))
+        return;
+    }
+  }
+}
+
+}  // namespace passport
+
+}  // namespace maidsafe
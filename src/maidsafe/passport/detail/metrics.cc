@@ -0,0 +1,138 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/passport/metrics.h"
+
+#include <atomic>
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace {
+
+struct AtomicOperationMetrics {
+  std::atomic<std::uint64_t> count;
+  std::atomic<std::uint64_t> total_microseconds;
+  std::array<std::atomic<std::uint64_t>, kLatencyBucketCount> latency_histogram;
+};
+
+// Zero-initialised, since they have static storage duration.
+std::atomic<bool> g_enabled;
+std::array<AtomicOperationMetrics, kOperationCount> g_metrics;
+
+std::size_t LatencyBucket(std::uint64_t microseconds) {
+  std::size_t bucket(0);
+  while (microseconds > 1 && bucket < kLatencyBucketCount - 1) {
+    microseconds >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+void Record(Operation operation, std::chrono::steady_clock::duration duration) {
+  const std::uint64_t microseconds(static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(duration).count()));
+  auto& metrics(g_metrics[static_cast<std::size_t>(operation)]);
+  metrics.count.fetch_add(1, std::memory_order_relaxed);
+  metrics.total_microseconds.fetch_add(microseconds, std::memory_order_relaxed);
+  metrics.latency_histogram[LatencyBucket(microseconds)].fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // unnamed namespace
+
+void EnableMetrics(bool enable) { g_enabled.store(enable, std::memory_order_relaxed); }
+
+bool MetricsEnabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+Metrics GetMetrics() {
+  Metrics snapshot;
+  for (std::size_t i(0); i < kOperationCount; ++i) {
+    snapshot.operations[i].count = g_metrics[i].count.load(std::memory_order_relaxed);
+    snapshot.operations[i].total_microseconds =
+        g_metrics[i].total_microseconds.load(std::memory_order_relaxed);
+    for (std::size_t j(0); j < kLatencyBucketCount; ++j) {
+      snapshot.operations[i].latency_histogram[j] =
+          g_metrics[i].latency_histogram[j].load(std::memory_order_relaxed);
+    }
+  }
+  return snapshot;
+}
+
+void ResetMetrics() {
+  for (auto& metrics : g_metrics) {
+    metrics.count.store(0, std::memory_order_relaxed);
+    metrics.total_microseconds.store(0, std::memory_order_relaxed);
+    for (auto& bucket : metrics.latency_histogram)
+      bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+const char* OperationName(Operation operation) {
+  switch (operation) {
+    case Operation::kKeyGeneration:
+      return "KeyGeneration";
+    case Operation::kCreateValidationToken:
+      return "CreateValidationToken";
+    case Operation::kValidateToken:
+      return "ValidateToken";
+    case Operation::kFobEncrypt:
+      return "FobEncrypt";
+    case Operation::kFobDecrypt:
+      return "FobDecrypt";
+    case Operation::kPublicFobParse:
+      return "PublicFobParse";
+    case Operation::kSessionCreation:
+      return "SessionCreation";
+    case Operation::kPassportSave:
+      return "PassportSave";
+    case Operation::kPassportLoad:
+      return "PassportLoad";
+    case Operation::kPassportLockWait:
+      return "PassportLockWait";
+    default:
+      return "Unknown";
+  }
+}
+
+namespace detail {
+
+ScopedTimer::ScopedTimer(Operation operation)
+    : operation_(operation),
+      enabled_(MetricsEnabled()),
+      start_(enabled_ ? std::chrono::steady_clock::now()
+                      : std::chrono::steady_clock::time_point()),
+      trace_event_(operation) {}
+
+ScopedTimer::ScopedTimer(Operation operation, DataTagValue fob_type)
+    : operation_(operation),
+      enabled_(MetricsEnabled()),
+      start_(enabled_ ? std::chrono::steady_clock::now()
+                      : std::chrono::steady_clock::time_point()),
+      trace_event_(operation, fob_type) {}
+
+ScopedTimer::~ScopedTimer() {
+  if (enabled_)
+    Record(operation_, std::chrono::steady_clock::now() - start_);
+}
+
+}  // namespace detail
+
+}  // namespace passport
+
+}  // namespace maidsafe
@@ -24,6 +24,9 @@
 #include "maidsafe/common/authentication/user_credential_utils.h"
 #include "maidsafe/common/serialisation/serialisation.h"
 
+#include "maidsafe/passport/detail/keys_and_signers.h"
+#include "maidsafe/passport/detail/parallel.h"
+
 namespace maidsafe {
 
 namespace passport {
@@ -31,45 +34,293 @@ namespace passport {
 namespace {
 
 template <typename Key>
-void CheckThenAddKeyAndSigner(std::vector<std::pair<Key, typename Key::Signer>>& keys_and_signers,
-                              std::mutex& mutex,
+void CheckThenAddKeyAndSigner(detail::KeysAndSigners<Key>& keys_and_signers,
+                              detail::TimedSharedMutex& mutex,
                               std::pair<Key, typename Key::Signer> key_and_signer) {
-  std::lock_guard<std::mutex> lock{mutex};
-  if (std::any_of(std::begin(keys_and_signers), std::end(keys_and_signers),
-                  [&](const std::pair<Key, typename Key::Signer>& existing_pair) {
-        return key_and_signer.first.name() == existing_pair.first.name() ||
-               key_and_signer.second.name() == existing_pair.second.name();
-      })) {
-    LOG(kError) << "Key or signer already exists in passport - use unique keys and signers.";
-    BOOST_THROW_EXCEPTION(MakeError(PassportErrors::id_already_exists));
-  }
-  keys_and_signers.emplace_back(std::move(key_and_signer));
+  std::lock_guard<detail::TimedSharedMutex> lock{mutex};
+  keys_and_signers.Add(std::move(key_and_signer));
 }
 
 template <typename Key>
-std::vector<Key> GetKeys(const std::vector<std::pair<Key, typename Key::Signer>>& keys_and_signers,
-                         std::mutex& mutex) {
+std::vector<Key> GetKeys(const detail::KeysAndSigners<Key>& keys_and_signers,
+                         detail::TimedSharedMutex& mutex) {
   std::vector<Key> keys;
-  std::lock_guard<std::mutex> lock{mutex};
+  boost::shared_lock<detail::TimedSharedMutex> lock{mutex};
+  keys.reserve(keys_and_signers.size());
   for (const auto& key_and_signer : keys_and_signers)
     keys.push_back(key_and_signer.first);
   return keys;
 }
 
 template <typename Key>
-typename Key::Signer RemovePassportKeyAndSigner(
-    std::vector<std::pair<Key, typename Key::Signer>>& keys_and_signers, std::mutex& mutex,
-    const Key& key_to_be_removed) {
-  std::lock_guard<std::mutex> lock{mutex};
-  auto itr(std::find_if(std::begin(keys_and_signers), std::end(keys_and_signers),
-                        [&](const std::pair<Key, typename Key::Signer>& existing_pair) {
-    return key_to_be_removed.name() == existing_pair.first.name();
-  }));
-  if (itr == std::end(keys_and_signers))
+Key FindKey(const detail::KeysAndSigners<Key>& keys_and_signers,
+            detail::TimedSharedMutex& mutex, const typename Key::Name& key_name) {
+  boost::shared_lock<detail::TimedSharedMutex> lock{mutex};
+  const auto* key_and_signer(keys_and_signers.Find(key_name));
+  if (!key_and_signer)
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::no_such_element));
-  typename Key::Signer signer{std::move(itr->second)};
-  keys_and_signers.erase(itr);
-  return signer;
+  return key_and_signer->first;
+}
+
+template <typename Key>
+typename Key::Signer RemovePassportKeyAndSigner(detail::KeysAndSigners<Key>& keys_and_signers,
+                                                detail::TimedSharedMutex& mutex,
+                                                const Key& key_to_be_removed) {
+  std::lock_guard<detail::TimedSharedMutex> lock{mutex};
+  return keys_and_signers.Remove(key_to_be_removed.name());
+}
+
+template <typename Key>
+detail::KeysAndSigners<Key> MakeKeysAndSigners(
+    std::vector<std::pair<Key, typename Key::Signer>> keys_and_signers) {
+  detail::KeysAndSigners<Key> indexed_keys_and_signers;
+  for (auto& key_and_signer : keys_and_signers)
+    indexed_keys_and_signers.Add(std::move(key_and_signer));
+  return indexed_keys_and_signers;
+}
+
+using detail::EncryptedKeyAndSigner;
+
+std::vector<EncryptedKeyAndSigner> ParseEncryptedKeysAndSigners(
+    InputVectorStream& binary_input_stream, std::uint32_t count) {
+  std::vector<EncryptedKeyAndSigner> encrypted_keys_and_signers;
+  for (std::uint32_t i = 0; i < count; ++i) {
+    crypto::CipherText encrypted_fob(Parse<crypto::CipherText>(binary_input_stream));
+    crypto::CipherText encrypted_signer(Parse<crypto::CipherText>(binary_input_stream));
+    encrypted_keys_and_signers.emplace_back(std::move(encrypted_fob), std::move(encrypted_signer));
+  }
+  return encrypted_keys_and_signers;
+}
+
+// Each fob is decrypted and validated independently, so all of them are spread across threads.
+template <typename Key>
+std::vector<std::pair<Key, typename Key::Signer>> DecryptKeysAndSigners(
+    const std::vector<EncryptedKeyAndSigner>& encrypted_keys_and_signers,
+    const crypto::AES256Key& symm_key, const crypto::AES256InitialisationVector& symm_iv) {
+  std::vector<std::unique_ptr<Key>> keys(encrypted_keys_and_signers.size());
+  std::vector<std::unique_ptr<typename Key::Signer>> signers(encrypted_keys_and_signers.size());
+  detail::ParallelFor(2 * encrypted_keys_and_signers.size(), [&](std::size_t index) {
+    const EncryptedKeyAndSigner& encrypted(encrypted_keys_and_signers[index / 2]);
+    if (index % 2 == 0) {
+      keys[index / 2] = maidsafe::make_unique<Key>(encrypted.first, symm_key, symm_iv);
+    } else {
+      signers[index / 2] =
+          maidsafe::make_unique<typename Key::Signer>(encrypted.second, symm_key, symm_iv);
+    }
+  });
+  std::vector<std::pair<Key, typename Key::Signer>> keys_and_signers;
+  keys_and_signers.reserve(keys.size());
+  for (std::size_t i(0); i < keys.size(); ++i)
+    keys_and_signers.emplace_back(std::move(*keys[i]), std::move(*signers[i]));
+  return keys_and_signers;
+}
+
+// 'encrypted' must hold the ciphertexts of 'keys_and_signers', in the same order.
+template <typename Key>
+std::shared_ptr<const detail::CachedCiphertexts> MakeCachedCiphertexts(
+    const std::vector<std::pair<Key, typename Key::Signer>>& keys_and_signers,
+    std::vector<std::shared_ptr<const EncryptedKeyAndSigner>> encrypted,
+    const crypto::AES256Key& symm_key, const crypto::AES256InitialisationVector& symm_iv) {
+  auto cache(std::make_shared<detail::CachedCiphertexts>());
+  cache->symm_key = symm_key;
+  cache->symm_iv = symm_iv;
+  cache->entries.reserve(keys_and_signers.size());
+  for (std::size_t i(0); i < keys_and_signers.size(); ++i) {
+    cache->entries.emplace(
+        keys_and_signers[i].first.name().value,
+        detail::CachedCiphertext{keys_and_signers[i].second.name().value, std::move(encrypted[i])});
+  }
+  return cache;
+}
+
+std::vector<std::shared_ptr<const EncryptedKeyAndSigner>> ShareEncryptedKeysAndSigners(
+    const std::vector<EncryptedKeyAndSigner>& encrypted_keys_and_signers) {
+  std::vector<std::shared_ptr<const EncryptedKeyAndSigner>> shared;
+  shared.reserve(encrypted_keys_and_signers.size());
+  for (const auto& encrypted : encrypted_keys_and_signers)
+    shared.push_back(std::make_shared<const EncryptedKeyAndSigner>(encrypted));
+  return shared;
+}
+
+template <typename Encrypted>
+bool EncryptedWith(const Encrypted& encrypted, const crypto::AES256Key& symm_key,
+                   const crypto::AES256InitialisationVector& symm_iv) {
+  return encrypted.symm_key == symm_key && encrypted.symm_iv == symm_iv;
+}
+
+// Decrypts 'encrypted_keys_and_signers' (if it hasn't already been done) and installs the results in
+// 'keys_and_signers', keeping the ciphertexts in 'ciphertexts' for reuse.  The decryption is done
+// without holding the lock; if another thread completes it first, this thread's results are
+// discarded.
+template <typename Key>
+void DecryptPendingKeysAndSigners(
+    std::shared_ptr<const detail::EncryptedKeysAndSigners>& encrypted_keys_and_signers,
+    detail::KeysAndSigners<Key>& keys_and_signers,
+    std::shared_ptr<const detail::CachedCiphertexts>& ciphertexts,
+    detail::TimedSharedMutex& mutex) {
+  std::shared_ptr<const detail::EncryptedKeysAndSigners> pending;
+  {
+    boost::shared_lock<detail::TimedSharedMutex> lock{mutex};
+    pending = encrypted_keys_and_signers;
+  }
+  if (!pending)
+    return;
+
+  detail::ScopedTraceEvent trace_event("Passport::DecryptPending");
+  detail::KeysAndSigners<Key> decrypted;
+  std::shared_ptr<const detail::CachedCiphertexts> decrypted_ciphertexts;
+  try {
+    std::vector<std::pair<Key, typename Key::Signer>> decrypted_keys_and_signers(
+        DecryptKeysAndSigners<Key>(pending->keys_and_signers, pending->symm_key,
+                                   pending->symm_iv));
+    decrypted_ciphertexts = MakeCachedCiphertexts(
+        decrypted_keys_and_signers, ShareEncryptedKeysAndSigners(pending->keys_and_signers),
+        pending->symm_key, pending->symm_iv);
+    decrypted = MakeKeysAndSigners(std::move(decrypted_keys_and_signers));
+  } catch (const std::exception& e) {
+    LOG(kError) << "Failed to decrypt pending keys: " << e.what();
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  }
+
+  std::lock_guard<detail::TimedSharedMutex> lock{mutex};
+  if (encrypted_keys_and_signers == pending) {
+    keys_and_signers = std::move(decrypted);
+    ciphertexts = std::move(decrypted_ciphertexts);
+    encrypted_keys_and_signers.reset();
+  }
+}
+
+// The ciphertexts for one group of keys (e.g. the Pmids) being written out by Passport::ToString.
+// Those reused from the cache are set in 'encrypted'; 'changed' lists the indices of the pairs
+// which still need encrypting, and 'newly_encrypted' receives their ciphertexts.
+struct PendingEncryption {
+  std::vector<std::shared_ptr<const EncryptedKeyAndSigner>> encrypted;
+  std::vector<std::size_t> changed;
+  std::vector<EncryptedKeyAndSigner> newly_encrypted;
+};
+
+// Takes the ciphertexts of any pairs found in 'cache' (if it's valid for this key material) rather
+// than encrypting them again.
+template <typename Key>
+PendingEncryption PrepareEncryption(
+    const std::vector<std::pair<Key, typename Key::Signer>>& keys_and_signers,
+    const crypto::AES256Key& symm_key, const crypto::AES256InitialisationVector& symm_iv,
+    const std::shared_ptr<const detail::CachedCiphertexts>& cache) {
+  PendingEncryption pending;
+  pending.encrypted.resize(keys_and_signers.size());
+  const bool cache_valid(cache && EncryptedWith(*cache, symm_key, symm_iv));
+  for (std::size_t i(0); i < keys_and_signers.size(); ++i) {
+    if (cache_valid) {
+      auto itr(cache->entries.find(keys_and_signers[i].first.name().value));
+      if (itr != std::end(cache->entries) &&
+          itr->second.signer_name == keys_and_signers[i].second.name().value) {
+        pending.encrypted[i] = itr->second.ciphertexts;
+        continue;
+      }
+    }
+    pending.changed.push_back(i);
+  }
+  pending.newly_encrypted.resize(pending.changed.size());
+  return pending;
+}
+
+// Encrypts the key (for even 'index') or the signer (for odd 'index') of the pair listed at
+// 'index / 2' in 'pending.changed'.  May be called concurrently for different indices.
+template <typename Key>
+void EncryptChanged(const std::vector<std::pair<Key, typename Key::Signer>>& keys_and_signers,
+                    std::size_t index, const crypto::AES256Key& symm_key,
+                    const crypto::AES256InitialisationVector& symm_iv, PendingEncryption& pending) {
+  const auto& key_and_signer(keys_and_signers[pending.changed[index / 2]]);
+  auto& encrypted(pending.newly_encrypted[index / 2]);
+  if (index % 2 == 0)
+    encrypted.first = key_and_signer.first.Encrypt(symm_key, symm_iv);
+  else
+    encrypted.second = key_and_signer.second.Encrypt(symm_key, symm_iv);
+}
+
+// Returns the reused and newly-encrypted ciphertexts in the order of 'keys_and_signers'.
+// 'updated_cache' is set to hold exactly these.
+template <typename Key>
+std::vector<std::shared_ptr<const EncryptedKeyAndSigner>> FinishEncryption(
+    const std::vector<std::pair<Key, typename Key::Signer>>& keys_and_signers,
+    const crypto::AES256Key& symm_key, const crypto::AES256InitialisationVector& symm_iv,
+    PendingEncryption& pending, std::shared_ptr<const detail::CachedCiphertexts>& updated_cache) {
+  for (std::size_t i(0); i < pending.changed.size(); ++i) {
+    pending.encrypted[pending.changed[i]] =
+        std::make_shared<const EncryptedKeyAndSigner>(std::move(pending.newly_encrypted[i]));
+  }
+  updated_cache = MakeCachedCiphertexts(keys_and_signers, pending.encrypted, symm_key, symm_iv);
+  return std::move(pending.encrypted);
+}
+
+template <typename Key>
+std::future<std::pair<Key, typename Key::Signer>> CreateKeyAndSignerAsync() {
+  return std::async(std::launch::async, [] {
+    std::future<typename Key::Keys> keys(std::async(std::launch::async, [] {
+      return detail::GenerateFobKeys<typename Key::Tag>();
+    }));
+    typename Key::Signer signer;
+    return std::make_pair(Key{signer, keys.get()}, signer);
+  });
+}
+
+template <typename Key>
+std::future<std::pair<Key, typename Key::Signer>> CreateKeyAndSignerAsync(
+    const Executor& executor) {
+  using KeyAndSigner = std::pair<Key, typename Key::Signer>;
+  // The two key generations are posted as separate tasks.  Whichever finishes last does the signing,
+  // so neither task ever blocks waiting on the other (which could deadlock a small executor).
+  struct State {
+    std::promise<KeyAndSigner> promise;
+    std::unique_ptr<typename Key::Signer> signer;
+    std::unique_ptr<typename Key::Keys> keys;
+    std::exception_ptr error;
+    std::mutex mutex;
+    int outstanding = 2;
+  };
+  auto state(std::make_shared<State>());
+  std::future<KeyAndSigner> future(state->promise.get_future());
+
+  auto finish_task = [state](std::exception_ptr error) {
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (error && !state->error)
+        state->error = error;
+      if (--state->outstanding != 0)
+        return;
+    }
+    if (state->error) {
+      state->promise.set_exception(state->error);
+      return;
+    }
+    try {
+      Key key{*state->signer, std::move(*state->keys)};
+      state->promise.set_value(std::make_pair(std::move(key), std::move(*state->signer)));
+    } catch (...) {
+      state->promise.set_exception(std::current_exception());
+    }
+  };
+
+  executor([state, finish_task] {
+    std::exception_ptr error;
+    try {
+      state->keys = maidsafe::make_unique<typename Key::Keys>(
+          detail::GenerateFobKeys<typename Key::Tag>());
+    } catch (...) {
+      error = std::current_exception();
+    }
+    finish_task(error);
+  });
+  executor([state, finish_task] {
+    std::exception_ptr error;
+    try {
+      state->signer = maidsafe::make_unique<typename Key::Signer>();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    finish_task(error);
+  });
+  return future;
 }
 
 }  // unnamed namespace
@@ -119,51 +370,147 @@ MpidAndSigner CreateMpidAndSigner() {
   return std::make_pair(Mpid{signer}, signer);
 }
 
+MaidAndSigner CreateMaidAndSigner(KeyPool& key_pool) {
+  Maid::Signer signer{key_pool.Get<Maid::Signer::Tag>()};
+  return std::make_pair(Maid{signer, key_pool.Get<Maid::Tag>()}, signer);
+}
+
+PmidAndSigner CreatePmidAndSigner(KeyPool& key_pool) {
+  Pmid::Signer signer{key_pool.Get<Pmid::Signer::Tag>()};
+  return std::make_pair(Pmid{signer, key_pool.Get<Pmid::Tag>()}, signer);
+}
+
+MpidAndSigner CreateMpidAndSigner(KeyPool& key_pool) {
+  Mpid::Signer signer{key_pool.Get<Mpid::Signer::Tag>()};
+  return std::make_pair(Mpid{signer, key_pool.Get<Mpid::Tag>()}, signer);
+}
+
+std::future<MaidAndSigner> CreateMaidAndSignerAsync() { return CreateKeyAndSignerAsync<Maid>(); }
+
+std::future<PmidAndSigner> CreatePmidAndSignerAsync() { return CreateKeyAndSignerAsync<Pmid>(); }
+
+std::future<MpidAndSigner> CreateMpidAndSignerAsync() { return CreateKeyAndSignerAsync<Mpid>(); }
+
+std::future<MaidAndSigner> CreateMaidAndSignerAsync(const Executor& executor) {
+  return CreateKeyAndSignerAsync<Maid>(executor);
+}
+
+std::future<PmidAndSigner> CreatePmidAndSignerAsync(const Executor& executor) {
+  return CreateKeyAndSignerAsync<Pmid>(executor);
+}
+
+std::future<MpidAndSigner> CreateMpidAndSignerAsync(const Executor& executor) {
+  return CreateKeyAndSignerAsync<Mpid>(executor);
+}
+
+PassportSession::PassportSession(const authentication::UserCredentials& user_credentials)
+    : user_credentials_(maidsafe::make_unique<authentication::UserCredentials>()),
+      symm_key_(),
+      symm_iv_() {
+  if (!user_credentials.keyword || !user_credentials.pin || !user_credentials.password) {
+    LOG(kError) << "All user credential fields must be set to create a passport session.";
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+  }
+  detail::ScopedTimer timer(Operation::kSessionCreation);
+  crypto::SecurePassword secure_password(authentication::CreateSecurePassword(user_credentials));
+  symm_key_ = authentication::DeriveSymmEncryptKey(secure_password);
+  symm_iv_ = authentication::DeriveSymmEncryptIv(secure_password);
+  user_credentials_->keyword = maidsafe::make_unique<authentication::UserCredentials::Keyword>(
+      *user_credentials.keyword);
+  user_credentials_->pin =
+      maidsafe::make_unique<authentication::UserCredentials::Pin>(*user_credentials.pin);
+  user_credentials_->password = maidsafe::make_unique<authentication::UserCredentials::Password>(
+      *user_credentials.password);
+}
+
+PassportSession::~PassportSession() {}
+
 Passport::Passport(MaidAndSigner maid_and_signer)
     : maid_and_signer_(maidsafe::make_unique<MaidAndSigner>(std::move(maid_and_signer))),
       pmids_and_signers_(),
       mpids_and_signers_(),
+      encrypted_pmids_and_signers_(),
+      encrypted_mpids_and_signers_(),
+      pmid_ciphertexts_(),
+      mpid_ciphertexts_(),
       mutex_() {}
 
 Passport::Passport(const crypto::CipherText& encrypted_passport,
-                   const authentication::UserCredentials& user_credentials)
-    : maid_and_signer_(), pmids_and_signers_(), mpids_and_signers_(), mutex_() {
-  crypto::SecurePassword secure_password(authentication::CreateSecurePassword(user_credentials));
-  crypto::AES256Key symm_key(authentication::DeriveSymmEncryptKey(secure_password));
-  crypto::AES256InitialisationVector symm_iv(authentication::DeriveSymmEncryptIv(secure_password));
-  FromString(authentication::Obfuscate(user_credentials,
-                                       crypto::SymmDecrypt(encrypted_passport, symm_key, symm_iv)),
-             symm_key, symm_iv);
+                   const authentication::UserCredentials& user_credentials, DecryptionMode mode)
+    : Passport(encrypted_passport, PassportSession(user_credentials), mode) {}
+
+Passport::Passport(const crypto::CipherText& encrypted_passport, const PassportSession& session,
+                   DecryptionMode mode)
+    : maid_and_signer_(),
+      pmids_and_signers_(),
+      mpids_and_signers_(),
+      encrypted_pmids_and_signers_(),
+      encrypted_mpids_and_signers_(),
+      pmid_ciphertexts_(),
+      mpid_ciphertexts_(),
+      mutex_() {
+  detail::ScopedTimer timer(Operation::kPassportLoad);
+  FromString(authentication::Obfuscate(*session.user_credentials_,
+                                       crypto::SymmDecrypt(encrypted_passport, session.symm_key_,
+                                                           session.symm_iv_)),
+             session.symm_key_, session.symm_iv_, mode);
 }
 
 void Passport::FromString(const NonEmptyString& serialised_passport,
                           const crypto::AES256Key& symm_key,
-                          const crypto::AES256InitialisationVector& symm_iv) {
+                          const crypto::AES256InitialisationVector& symm_iv, DecryptionMode mode) {
+  detail::ScopedTraceEvent trace_event("Passport::FromString");
   try {
     std::string contents(serialised_passport.string());
     InputVectorStream binary_input_stream(SerialisedData(contents.begin(), contents.end()));
-    std::lock_guard<std::mutex> lock(mutex_);
-    crypto::CipherText encrypted_fob(Parse<crypto::CipherText>(binary_input_stream));
-    crypto::CipherText encrypted_signer(Parse<crypto::CipherText>(binary_input_stream));
-    maid_and_signer_ = maidsafe::make_unique<MaidAndSigner>(
-        std::make_pair(Maid(std::move(encrypted_fob), symm_key, symm_iv),
-                       Anmaid(std::move(encrypted_signer), symm_key, symm_iv)));
+    std::vector<EncryptedKeyAndSigner> encrypted_maid_and_signer(
+        ParseEncryptedKeysAndSigners(binary_input_stream, 1));
     std::uint32_t pmids_and_signers_size(Parse<std::uint32_t>(binary_input_stream));
     std::uint32_t mpids_and_signers_size(Parse<std::uint32_t>(binary_input_stream));
-    for (std::uint32_t i = 0; i < pmids_and_signers_size; ++i) {
-      encrypted_fob = Parse<crypto::CipherText>(binary_input_stream);
-      encrypted_signer = Parse<crypto::CipherText>(binary_input_stream);
-      pmids_and_signers_.push_back(
-          std::make_pair(Pmid(std::move(encrypted_fob), symm_key, symm_iv),
-                         Anpmid(std::move(encrypted_signer), symm_key, symm_iv)));
-    }
-    for (std::uint32_t i = 0; i < mpids_and_signers_size; ++i) {
-      encrypted_fob = Parse<crypto::CipherText>(binary_input_stream);
-      encrypted_signer = Parse<crypto::CipherText>(binary_input_stream);
-      mpids_and_signers_.push_back(
-          std::make_pair(Mpid(std::move(encrypted_fob), symm_key, symm_iv),
-                         Anmpid(std::move(encrypted_signer), symm_key, symm_iv)));
+    std::vector<EncryptedKeyAndSigner> encrypted_pmids_and_signers(
+        ParseEncryptedKeysAndSigners(binary_input_stream, pmids_and_signers_size));
+    std::vector<EncryptedKeyAndSigner> encrypted_mpids_and_signers(
+        ParseEncryptedKeysAndSigners(binary_input_stream, mpids_and_signers_size));
+
+    // The expensive part - decrypting and validating each fob - is done without holding the lock.
+    std::vector<MaidAndSigner> maid_and_signer(
+        DecryptKeysAndSigners<Maid>(encrypted_maid_and_signer, symm_key, symm_iv));
+    if (mode == DecryptionMode::kLazy) {
+      auto make_pending = [&](std::vector<EncryptedKeyAndSigner>& encrypted) {
+        return std::make_shared<const detail::EncryptedKeysAndSigners>(
+            detail::EncryptedKeysAndSigners{std::move(encrypted), symm_key, symm_iv});
+      };
+      auto pending_pmids(make_pending(encrypted_pmids_and_signers));
+      auto pending_mpids(make_pending(encrypted_mpids_and_signers));
+      std::lock_guard<detail::TimedSharedMutex> lock(mutex_);
+      maid_and_signer_ = maidsafe::make_unique<MaidAndSigner>(std::move(maid_and_signer.front()));
+      encrypted_pmids_and_signers_ = std::move(pending_pmids);
+      encrypted_mpids_and_signers_ = std::move(pending_mpids);
+      return;
     }
+    std::vector<PmidAndSigner> decrypted_pmids_and_signers(
+        DecryptKeysAndSigners<Pmid>(encrypted_pmids_and_signers, symm_key, symm_iv));
+    std::vector<MpidAndSigner> decrypted_mpids_and_signers(
+        DecryptKeysAndSigners<Mpid>(encrypted_mpids_and_signers, symm_key, symm_iv));
+    // The ciphertexts just parsed are kept, so that saving again with the same key material only
+    // needs to encrypt what has changed.
+    auto pmid_ciphertexts(MakeCachedCiphertexts(
+        decrypted_pmids_and_signers, ShareEncryptedKeysAndSigners(encrypted_pmids_and_signers),
+        symm_key, symm_iv));
+    auto mpid_ciphertexts(MakeCachedCiphertexts(
+        decrypted_mpids_and_signers, ShareEncryptedKeysAndSigners(encrypted_mpids_and_signers),
+        symm_key, symm_iv));
+    detail::KeysAndSigners<Pmid> pmids_and_signers(
+        MakeKeysAndSigners(std::move(decrypted_pmids_and_signers)));
+    detail::KeysAndSigners<Mpid> mpids_and_signers(
+        MakeKeysAndSigners(std::move(decrypted_mpids_and_signers)));
+
+    std::lock_guard<detail::TimedSharedMutex> lock(mutex_);
+    maid_and_signer_ = maidsafe::make_unique<MaidAndSigner>(std::move(maid_and_signer.front()));
+    pmids_and_signers_ = std::move(pmids_and_signers);
+    mpids_and_signers_ = std::move(mpids_and_signers);
+    pmid_ciphertexts_ = std::move(pmid_ciphertexts);
+    mpid_ciphertexts_ = std::move(mpid_ciphertexts);
   } catch (const std::exception&) {
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
   }
@@ -171,59 +518,166 @@ void Passport::FromString(const NonEmptyString& serialised_passport,
 
 NonEmptyString Passport::ToString(const crypto::AES256Key& symm_key,
                                   const crypto::AES256InitialisationVector& symm_iv) const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  if (!maid_and_signer_) {
-    LOG(kError) << "Passport must contain a Maid in order to be serialised.";
-    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::serialisation_error));
+  detail::ScopedTraceEvent trace_event("Passport::ToString");
+  // Keys still pending decryption can be written out as they are, unless the key material differs.
+  std::shared_ptr<const detail::EncryptedKeysAndSigners> pending_pmids, pending_mpids;
+  {
+    boost::shared_lock<detail::TimedSharedMutex> lock(mutex_);
+    pending_pmids = encrypted_pmids_and_signers_;
+    pending_mpids = encrypted_mpids_and_signers_;
   }
-  OutputVectorStream binary_output_stream;
-  Serialise(binary_output_stream, maid_and_signer_->first.Encrypt(symm_key, symm_iv)->string(),
-            maid_and_signer_->second.Encrypt(symm_key, symm_iv)->string(),
-            static_cast<std::uint32_t>(pmids_and_signers_.size()),
-            static_cast<std::uint32_t>(mpids_and_signers_.size()));
-  for (const auto& pmid_and_signer : pmids_and_signers_) {
-    Serialise(binary_output_stream, pmid_and_signer.first.Encrypt(symm_key, symm_iv),
-              pmid_and_signer.second.Encrypt(symm_key, symm_iv));
+  if (pending_pmids && !EncryptedWith(*pending_pmids, symm_key, symm_iv))
+    DecryptPendingPmids();
+  if (pending_mpids && !EncryptedWith(*pending_mpids, symm_key, symm_iv))
+    DecryptPendingMpids();
+
+  // Take a snapshot of the keys so that the lock isn't held while encrypting.
+  std::vector<MaidAndSigner> maid_and_signer;
+  std::vector<PmidAndSigner> pmids_and_signers;
+  std::vector<MpidAndSigner> mpids_and_signers;
+  std::shared_ptr<const detail::CachedCiphertexts> pmid_ciphertexts, mpid_ciphertexts;
+  {
+    boost::shared_lock<detail::TimedSharedMutex> lock(mutex_);
+    if (!maid_and_signer_) {
+      LOG(kError) << "Passport must contain a Maid in order to be serialised.";
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::serialisation_error));
+    }
+    maid_and_signer.push_back(*maid_and_signer_);
+    // Pending sets can only have been reset (never replaced) since they were checked above.
+    pending_pmids = encrypted_pmids_and_signers_;
+    pending_mpids = encrypted_mpids_and_signers_;
+    if (!pending_pmids) {
+      pmids_and_signers.assign(std::begin(pmids_and_signers_), std::end(pmids_and_signers_));
+      pmid_ciphertexts = pmid_ciphertexts_;
+    }
+    if (!pending_mpids) {
+      mpids_and_signers.assign(std::begin(mpids_and_signers_), std::end(mpids_and_signers_));
+      mpid_ciphertexts = mpid_ciphertexts_;
+    }
+  }
+
+  // The Maid, its signer and every Pmid, Mpid and signer not reused from the caches are encrypted
+  // together in a single ParallelFor.
+  PendingEncryption pending_pmid_encryption, pending_mpid_encryption;
+  if (!pending_pmids) {
+    pending_pmid_encryption =
+        PrepareEncryption(pmids_and_signers, symm_key, symm_iv, pmid_ciphertexts);
   }
-  for (const auto& mpid_and_signer : mpids_and_signers_) {
-    Serialise(binary_output_stream, mpid_and_signer.first.Encrypt(symm_key, symm_iv),
-              mpid_and_signer.second.Encrypt(symm_key, symm_iv));
+  if (!pending_mpids) {
+    pending_mpid_encryption =
+        PrepareEncryption(mpids_and_signers, symm_key, symm_iv, mpid_ciphertexts);
   }
+  EncryptedKeyAndSigner encrypted_maid_and_signer;
+  const std::size_t pmid_tasks(2 * pending_pmid_encryption.changed.size());
+  const std::size_t mpid_tasks(2 * pending_mpid_encryption.changed.size());
+  detail::ParallelFor(2 + pmid_tasks + mpid_tasks, [&](std::size_t index) {
+    if (index == 0) {
+      encrypted_maid_and_signer.first = maid_and_signer.front().first.Encrypt(symm_key, symm_iv);
+    } else if (index == 1) {
+      encrypted_maid_and_signer.second = maid_and_signer.front().second.Encrypt(symm_key, symm_iv);
+    } else if (index < 2 + pmid_tasks) {
+      EncryptChanged(pmids_and_signers, index - 2, symm_key, symm_iv, pending_pmid_encryption);
+    } else {
+      EncryptChanged(mpids_and_signers, index - 2 - pmid_tasks, symm_key, symm_iv,
+                     pending_mpid_encryption);
+    }
+  });
+
+  std::shared_ptr<const detail::CachedCiphertexts> updated_pmid_ciphertexts,
+      updated_mpid_ciphertexts;
+  std::vector<std::shared_ptr<const EncryptedKeyAndSigner>> encrypted_pmids_and_signers(
+      pending_pmids ? ShareEncryptedKeysAndSigners(pending_pmids->keys_and_signers)
+                    : FinishEncryption(pmids_and_signers, symm_key, symm_iv,
+                                       pending_pmid_encryption, updated_pmid_ciphertexts));
+  std::vector<std::shared_ptr<const EncryptedKeyAndSigner>> encrypted_mpids_and_signers(
+      pending_mpids ? ShareEncryptedKeysAndSigners(pending_mpids->keys_and_signers)
+                    : FinishEncryption(mpids_and_signers, symm_key, symm_iv,
+                                       pending_mpid_encryption, updated_mpid_ciphertexts));
+  if (updated_pmid_ciphertexts || updated_mpid_ciphertexts) {
+    std::lock_guard<detail::TimedSharedMutex> lock(mutex_);
+    if (updated_pmid_ciphertexts)
+      pmid_ciphertexts_ = std::move(updated_pmid_ciphertexts);
+    if (updated_mpid_ciphertexts)
+      mpid_ciphertexts_ = std::move(updated_mpid_ciphertexts);
+  }
+
+  OutputVectorStream binary_output_stream;
+  Serialise(binary_output_stream, encrypted_maid_and_signer.first->string(),
+            encrypted_maid_and_signer.second->string(),
+            static_cast<std::uint32_t>(encrypted_pmids_and_signers.size()),
+            static_cast<std::uint32_t>(encrypted_mpids_and_signers.size()));
+  for (const auto& encrypted_pmid_and_signer : encrypted_pmids_and_signers)
+    Serialise(binary_output_stream, encrypted_pmid_and_signer->first,
+              encrypted_pmid_and_signer->second);
+  for (const auto& encrypted_mpid_and_signer : encrypted_mpids_and_signers)
+    Serialise(binary_output_stream, encrypted_mpid_and_signer->first,
+              encrypted_mpid_and_signer->second);
   SerialisedData contents(binary_output_stream.vector());
   return NonEmptyString(std::string(contents.begin(), contents.end()));
 }
 
 crypto::CipherText Passport::Encrypt(
     const authentication::UserCredentials& user_credentials) const {
-  crypto::SecurePassword secure_password(authentication::CreateSecurePassword(user_credentials));
-  crypto::AES256Key symm_key(authentication::DeriveSymmEncryptKey(secure_password));
-  crypto::AES256InitialisationVector symm_iv(authentication::DeriveSymmEncryptIv(secure_password));
-  return crypto::SymmEncrypt(
-      authentication::Obfuscate(user_credentials, ToString(symm_key, symm_iv)), symm_key, symm_iv);
+  return Encrypt(PassportSession(user_credentials));
+}
+
+crypto::CipherText Passport::Encrypt(const PassportSession& session) const {
+  detail::ScopedTimer timer(Operation::kPassportSave);
+  return crypto::SymmEncrypt(authentication::Obfuscate(*session.user_credentials_,
+                                                       ToString(session.symm_key_, session.symm_iv_)),
+                             session.symm_key_, session.symm_iv_);
 }
 
 Maid Passport::GetMaid() const {
-  std::lock_guard<std::mutex> lock{mutex_};
+  boost::shared_lock<detail::TimedSharedMutex> lock{mutex_};
   if (!maid_and_signer_)
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::no_such_element));
   return maid_and_signer_->first;
 }
 
+void Passport::DecryptPendingPmids() const {
+  DecryptPendingKeysAndSigners(encrypted_pmids_and_signers_, pmids_and_signers_, pmid_ciphertexts_,
+                               mutex_);
+}
+
+void Passport::DecryptPendingMpids() const {
+  DecryptPendingKeysAndSigners(encrypted_mpids_and_signers_, mpids_and_signers_, mpid_ciphertexts_,
+                               mutex_);
+}
+
 void Passport::AddKeyAndSigner(PmidAndSigner pmid_and_signer) {
+  DecryptPendingPmids();
   CheckThenAddKeyAndSigner(pmids_and_signers_, mutex_, pmid_and_signer);
 }
 
 void Passport::AddKeyAndSigner(MpidAndSigner mpid_and_signer) {
+  DecryptPendingMpids();
   CheckThenAddKeyAndSigner(mpids_and_signers_, mutex_, mpid_and_signer);
 }
 
-std::vector<Pmid> Passport::GetPmids() const { return GetKeys(pmids_and_signers_, mutex_); }
+std::vector<Pmid> Passport::GetPmids() const {
+  DecryptPendingPmids();
+  return GetKeys(pmids_and_signers_, mutex_);
+}
+
+std::vector<Mpid> Passport::GetMpids() const {
+  DecryptPendingMpids();
+  return GetKeys(mpids_and_signers_, mutex_);
+}
 
-std::vector<Mpid> Passport::GetMpids() const { return GetKeys(mpids_and_signers_, mutex_); }
+Pmid Passport::FindPmid(const Pmid::Name& pmid_name) const {
+  DecryptPendingPmids();
+  return FindKey(pmids_and_signers_, mutex_, pmid_name);
+}
+
+Mpid Passport::FindMpid(const Mpid::Name& mpid_name) const {
+  DecryptPendingMpids();
+  return FindKey(mpids_and_signers_, mutex_, mpid_name);
+}
 
 template <>
 Maid::Signer Passport::RemoveKeyAndSigner<Maid>(const Maid& key_to_be_removed) {
-  std::lock_guard<std::mutex> lock{mutex_};
+  std::lock_guard<detail::TimedSharedMutex> lock{mutex_};
   if (!maid_and_signer_ || maid_and_signer_->first.name() != key_to_be_removed.name())
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::no_such_element));
   Maid::Signer signer{std::move(maid_and_signer_->second)};
@@ -233,17 +687,19 @@ Maid::Signer Passport::RemoveKeyAndSigner<Maid>(const Maid& key_to_be_removed) {
 
 template <>
 Pmid::Signer Passport::RemoveKeyAndSigner<Pmid>(const Pmid& key_to_be_removed) {
+  DecryptPendingPmids();
   return RemovePassportKeyAndSigner(pmids_and_signers_, mutex_, key_to_be_removed);
 }
 
 template <>
 Mpid::Signer Passport::RemoveKeyAndSigner<Mpid>(const Mpid& key_to_be_removed) {
+  DecryptPendingMpids();
   return RemovePassportKeyAndSigner(mpids_and_signers_, mutex_, key_to_be_removed);
 }
 
 Maid::Signer Passport::ReplaceMaidAndSigner(const Maid& maid_to_be_replaced,
                                             MaidAndSigner new_maid_and_signer) {
-  std::lock_guard<std::mutex> lock{mutex_};
+  std::lock_guard<detail::TimedSharedMutex> lock{mutex_};
   if (!maid_and_signer_ || maid_and_signer_->first.name() != maid_to_be_replaced.name())
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::no_such_element));
   if (new_maid_and_signer.first.name() == maid_and_signer_->first.name() ||
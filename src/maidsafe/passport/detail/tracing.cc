@@ -0,0 +1,244 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/passport/tracing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "maidsafe/common/log.h"
+
+#include "maidsafe/passport/metrics.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace {
+
+struct TraceEvent {
+  const char* name;
+  const char* fob_type;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::duration duration;
+};
+
+// Beyond this many events per thread per session, further events are counted but not kept.
+const std::size_t kMaxEventsPerThread(1 << 16);
+const std::size_t kInitialEventsPerThread(1 << 10);
+
+// Each thread records into its own buffer, so ending an event only takes that buffer's mutex,
+// which is contended solely while 'StopTracing' collects it.  'session' is the session the events
+// belong to; a buffer holding an older session's events is cleared before it is next written to.
+struct ThreadBuffer {
+  explicit ThreadBuffer(std::uint32_t thread_id_in)
+      : mutex(), thread_id(thread_id_in), session(0), events(), dropped(0) {}
+
+  std::mutex mutex;
+  const std::uint32_t thread_id;  // Small sequential ids read better in the viewers.
+  unsigned session;
+  std::vector<TraceEvent> events;
+  std::size_t dropped;
+};
+
+// Each call to 'StartTracing' begins a new session; events are only kept if they started and ended
+// within the current one.  0 means tracing is disabled.
+std::atomic<unsigned> g_session;
+unsigned g_last_session(0);
+std::chrono::steady_clock::time_point g_session_start;
+// Guards the above (other than 'g_session') and the list of every thread's buffer.  A buffer is
+// owned jointly by its thread and this list, so it is only dropped from the list once its thread
+// has exited.
+std::vector<std::shared_ptr<ThreadBuffer>> g_buffers;
+std::uint32_t g_last_thread_id(0);
+std::mutex g_mutex;
+
+ThreadBuffer& ThisThreadBuffer() {
+  thread_local const std::shared_ptr<ThreadBuffer> buffer([] {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_buffers.emplace_back(std::make_shared<ThreadBuffer>(++g_last_thread_id));
+    return g_buffers.back();
+  }());
+  return *buffer;
+}
+
+void RemoveExitedThreadBuffers() {
+  g_buffers.erase(std::remove_if(std::begin(g_buffers), std::end(g_buffers),
+                                 [](const std::shared_ptr<ThreadBuffer>& buffer) {
+                                   return buffer.use_count() == 1;
+                                 }),
+                  std::end(g_buffers));
+}
+
+const char* FobTypeName(DataTagValue tag_value) {
+  switch (tag_value) {
+    case DataTagValue::kAnmaidValue:
+      return "Anmaid";
+    case DataTagValue::kMaidValue:
+      return "Maid";
+    case DataTagValue::kAnpmidValue:
+      return "Anpmid";
+    case DataTagValue::kPmidValue:
+      return "Pmid";
+    case DataTagValue::kAnmpidValue:
+      return "Anmpid";
+    case DataTagValue::kMpidValue:
+      return "Mpid";
+    default:
+      return "Unknown";
+  }
+}
+
+std::int64_t Microseconds(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+}  // unnamed namespace
+
+void StartTracing() {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  RemoveExitedThreadBuffers();
+  g_session_start = std::chrono::steady_clock::now();
+  if (++g_last_session == 0)
+    ++g_last_session;
+  g_session.store(g_last_session);
+}
+
+bool TracingEnabled() { return g_session.load(std::memory_order_relaxed) != 0; }
+
+bool StopTracing(const boost::filesystem::path& path) {
+  std::vector<std::pair<std::uint32_t, std::vector<TraceEvent>>> events_by_thread;
+  std::size_t dropped(0);
+  std::chrono::steady_clock::time_point session_start;
+  {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    unsigned session(g_session.exchange(0));
+    if (session == 0) {
+      LOG(kError) << "StopTracing called while not tracing.";
+      return false;
+    }
+    session_start = g_session_start;
+    for (const auto& buffer : g_buffers) {
+      std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+      if (buffer->session == session && !buffer->events.empty()) {
+        events_by_thread.emplace_back(buffer->thread_id, std::move(buffer->events));
+        dropped += buffer->dropped;
+      }
+      buffer->session = 0;
+      buffer->events = std::vector<TraceEvent>();
+      buffer->dropped = 0;
+    }
+    RemoveExitedThreadBuffers();
+  }
+
+  if (dropped != 0) {
+    LOG(kWarning) << "Trace is missing " << dropped << " events; threads are limited to "
+                  << kMaxEventsPerThread << " events each.";
+  }
+  try {
+    std::ofstream output(path.string(), std::ios::binary | std::ios::trunc);
+    output.exceptions(std::ios::failbit | std::ios::badbit);
+    output << "{\"traceEvents\":[";
+    bool first(true);
+    for (const auto& thread_events : events_by_thread) {
+      for (const TraceEvent& event : thread_events.second) {
+        output << (first ? "\n" : ",\n") << "{\"name\":\"" << event.name
+               << "\",\"cat\":\"passport\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+               << thread_events.first << ",\"ts\":" << Microseconds(event.start - session_start)
+               << ",\"dur\":" << Microseconds(event.duration);
+        if (event.fob_type)
+          output << ",\"args\":{\"fob_type\":\"" << event.fob_type << "\"}";
+        output << '}';
+        first = false;
+      }
+    }
+    output << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  } catch (const std::exception& e) {
+    LOG(kError) << "Failed to write trace to " << path << ": " << e.what();
+    return false;
+  }
+  return true;
+}
+
+namespace detail {
+
+ScopedTraceEvent::ScopedTraceEvent(const char* name)
+    : session_(g_session.load(std::memory_order_relaxed)),
+      name_(name),
+      fob_type_(nullptr),
+      start_() {
+  if (session_ != 0)
+    start_ = std::chrono::steady_clock::now();
+}
+
+ScopedTraceEvent::ScopedTraceEvent(Operation operation)
+    : session_(g_session.load(std::memory_order_relaxed)),
+      name_(nullptr),
+      fob_type_(nullptr),
+      start_() {
+  if (session_ != 0) {
+    name_ = OperationName(operation);
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+ScopedTraceEvent::ScopedTraceEvent(Operation operation, DataTagValue fob_type)
+    : session_(g_session.load(std::memory_order_relaxed)),
+      name_(nullptr),
+      fob_type_(nullptr),
+      start_() {
+  if (session_ != 0) {
+    name_ = OperationName(operation);
+    fob_type_ = FobTypeName(fob_type);
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+ScopedTraceEvent::~ScopedTraceEvent() {
+  if (session_ == 0)
+    return;
+  TraceEvent event{name_, fob_type_, start_, std::chrono::steady_clock::now() - start_};
+  ThreadBuffer& buffer(ThisThreadBuffer());
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  // Checked under the buffer's mutex, so once 'StopTracing' has collected this buffer no further
+  // events from the stopped session can be added to it.
+  if (g_session.load(std::memory_order_relaxed) != session_)
+    return;
+  if (buffer.session != session_) {
+    buffer.session = session_;
+    buffer.events.clear();
+    buffer.events.reserve(kInitialEventsPerThread);
+    buffer.dropped = 0;
+  }
+  if (buffer.events.size() < kMaxEventsPerThread)
+    buffer.events.push_back(event);
+  else
+    ++buffer.dropped;
+}
+
+}  // namespace detail
+
+}  // namespace passport
+
+}  // namespace maidsafe
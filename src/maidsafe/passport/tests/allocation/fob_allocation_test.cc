@@ -0,0 +1,171 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+// This test replaces the global allocation functions in order to count allocations, so it is built
+// as its own executable (test_passport_allocation) rather than as part of test_passport.
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/serialisation/serialisation.h"
+
+#include "maidsafe/passport/types.h"
+#include "maidsafe/passport/detail/public_fob.h"
+#include "maidsafe/passport/tests/test_utils.h"
+
+namespace {
+
+// Counts the heap allocations made by the current thread, and records the size of the largest.
+thread_local std::size_t g_allocation_count(0);
+thread_local std::size_t g_largest_allocation(0);
+
+void CountAllocation(std::size_t size) {
+  ++g_allocation_count;
+  if (size > g_largest_allocation)
+    g_largest_allocation = size;
+}
+
+void* Allocate(std::size_t size) {
+  CountAllocation(size);
+  if (void* memory = std::malloc(size == 0 ? 1 : size))
+    return memory;
+  throw std::bad_alloc();
+}
+
+void* AllocateNoThrow(std::size_t size) noexcept {
+  try {
+    return Allocate(size);
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+
+}  // unnamed namespace
+
+void* operator new(std::size_t size) { return Allocate(size); }
+void* operator new[](std::size_t size) { return Allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return AllocateNoThrow(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return AllocateNoThrow(size);
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t /*size*/) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t /*size*/) noexcept { std::free(memory); }
+
+// The over-aligned forms only exist from C++17.  They're replaced too (where posix_memalign is
+// available) so that no allocation escapes the count.
+#if defined(__cpp_aligned_new) && !defined(_WIN32)
+namespace {
+
+void* AllocateAligned(std::size_t size, std::align_val_t alignment) {
+  CountAllocation(size);
+  const std::size_t align(static_cast<std::size_t>(alignment));
+  void* memory(nullptr);
+  if (posix_memalign(&memory, align < sizeof(void*) ? sizeof(void*) : align,
+                     size == 0 ? 1 : size) != 0) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+}  // unnamed namespace
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  return AllocateAligned(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return AllocateAligned(size, alignment);
+}
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+#endif
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace test {
+
+template <typename TagType>
+class FobAllocationTest : public testing::Test {
+ protected:
+  using Fob = detail::Fob<TagType>;
+};
+
+TYPED_TEST_CASE(FobAllocationTest, FobTagTypes);
+
+TYPED_TEST(FobAllocationTest, BEH_CopyWithoutAllocation) {
+  typename TestFixture::Fob fob(CreateFob<TypeParam>());
+  typename TestFixture::Fob other_fob(CreateFob<TypeParam>());
+  detail::PublicFob<TypeParam> public_fob(fob);
+
+  const std::size_t allocations_before(g_allocation_count);
+  typename TestFixture::Fob copied_fob(fob);
+  typename TestFixture::Fob assigned_fob(other_fob);
+  assigned_fob = copied_fob;
+  detail::PublicFob<TypeParam> copied_public_fob(public_fob);
+  const bool fob_key_shared(&assigned_fob.private_key() == &fob.private_key() &&
+                            &assigned_fob.public_key() == &fob.public_key() &&
+                            &assigned_fob.validation_token() == &fob.validation_token() &&
+                            &assigned_fob.name() == &fob.name());
+  const bool public_fob_key_shared(&copied_public_fob.public_key() == &public_fob.public_key() &&
+                                   &copied_public_fob.name() == &public_fob.name());
+  const std::size_t allocations_after(g_allocation_count);
+
+  EXPECT_EQ(allocations_before, allocations_after);
+  EXPECT_TRUE(fob_key_shared);
+  EXPECT_TRUE(public_fob_key_shared);
+  EXPECT_TRUE(Equal(fob, assigned_fob));
+}
+
+TYPED_TEST(FobAllocationTest, BEH_ParseWithoutCopyingInput) {
+  typename TestFixture::Fob fob(CreateFob<TypeParam>());
+  const SerialisedData serialised(Serialise(detail::PublicFob<TypeParam>(fob)));
+
+  // Any copy of the input would need a single allocation at least as large as it, whereas each
+  // decoded field is smaller than the whole.
+  std::string encoded_public_key;
+  typename TestFixture::Fob::ValidationToken validation_token;
+  g_largest_allocation = 0;
+  detail::ParsePublicFobFields(serialised.data(), serialised.size(), encoded_public_key,
+                               validation_token);
+  const std::size_t largest_allocation(g_largest_allocation);
+
+  EXPECT_LT(largest_allocation, serialised.size());
+  EXPECT_EQ(fob.encoded_public_key().string(), encoded_public_key);
+  EXPECT_TRUE(fob.validation_token() == validation_token);
+}
+
+}  // namespace test
+
+}  // namespace passport
+
+}  // namespace maidsafe
+
+int main(int argc, char** argv) { return maidsafe::test::ExecuteMain(argc, argv); }
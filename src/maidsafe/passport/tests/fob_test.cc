@@ -18,7 +18,12 @@
 
 #include "maidsafe/passport/detail/fob.h"
 
+#include <functional>
 #include <string>
+#include <type_traits>
+#include <vector>
+
+#include "cryptopp/integer.h"
 
 #include "maidsafe/common/log.h"
 #include "maidsafe/common/rsa.h"
@@ -27,6 +32,7 @@
 #include "maidsafe/common/serialisation/serialisation.h"
 
 #include "maidsafe/passport/types.h"
+#include "maidsafe/passport/detail/public_fob.h"
 #include "maidsafe/passport/tests/test_utils.h"
 
 namespace maidsafe {
@@ -35,6 +41,50 @@ namespace passport {
 
 namespace test {
 
+// A fob type whose signature policy counts its calls, to check that Fob and PublicFob do all their
+// signing and validation through the policy.
+struct CountingTag {
+  static const DataTagValue kValue = DataTagValue::kAnmaidValue;
+};
+
+const DataTagValue CountingTag::kValue;
+
+struct CountingPolicy : detail::RsaPssPolicy {
+  static Signature Sign(const asymm::PlainText& data, const PrivateKey& private_key) {
+    ++sign_count;
+    return detail::RsaPssPolicy::Sign(data, private_key);
+  }
+
+  static bool CheckSignature(const asymm::PlainText& data, const Signature& signature,
+                             const PublicKey& public_key) {
+    ++check_count;
+    return detail::RsaPssPolicy::CheckSignature(data, signature, public_key);
+  }
+
+  static int sign_count, check_count;
+};
+
+int CountingPolicy::sign_count(0);
+int CountingPolicy::check_count(0);
+
+}  // namespace test
+
+namespace detail {
+
+template <>
+struct SignaturePolicy<test::CountingTag> {
+  using type = test::CountingPolicy;
+};
+
+template <>
+struct KeySize<test::CountingTag> {
+  static const unsigned kBits = 1536;
+};
+
+}  // namespace detail
+
+namespace test {
+
 template <typename TagType>
 class FobTest : public testing::Test {
  protected:
@@ -86,6 +136,24 @@ TYPED_TEST(FobTest, BEH_ConstructAssignAndSwap) {
   EXPECT_TRUE(Equal(fob1, moved_fob));
 }
 
+TYPED_TEST(FobTest, BEH_MovedFrom) {
+  typename TestFixture::Fob fob(CreateFob<TypeParam>());
+  typename TestFixture::Fob original(fob);
+  typename TestFixture::Fob moved_to(std::move(fob));
+  EXPECT_TRUE(Equal(original, moved_to));
+  // The moved-from fob must still be safe to use.
+  EXPECT_TRUE(Equal(original, fob));
+  crypto::AES256Key symm_key(RandomString(crypto::AES256_KeySize));
+  crypto::AES256InitialisationVector symm_iv(RandomString(crypto::AES256_IVSize));
+  typename TestFixture::Fob decrypted_fob(fob.Encrypt(symm_key, symm_iv), symm_key, symm_iv);
+  EXPECT_TRUE(Equal(original, decrypted_fob));
+
+  typename TestFixture::Fob assigned_to(CreateFob<TypeParam>());
+  assigned_to = std::move(moved_to);
+  EXPECT_TRUE(Equal(original, assigned_to));
+  EXPECT_TRUE(Equal(original, moved_to));
+}
+
 TYPED_TEST(FobTest, BEH_EncryptAndDecrypt) {
   typename TestFixture::Fob fob(CreateFob<TypeParam>());
 
@@ -95,6 +163,8 @@ TYPED_TEST(FobTest, BEH_EncryptAndDecrypt) {
   crypto::CipherText encrypted_fob(fob.Encrypt(symm_key, symm_iv));
   typename TestFixture::Fob decrypted_fob(encrypted_fob, symm_key, symm_iv);
   EXPECT_TRUE(Equal(fob, decrypted_fob));
+  EXPECT_TRUE(asymm::EncodeKey(fob.public_key()) == fob.encoded_public_key());
+  EXPECT_TRUE(fob.encoded_public_key() == decrypted_fob.encoded_public_key());
 
   // Modfiy encrypted data and try to decrypt
   std::size_t index(RandomUint32() % encrypted_fob->string().size());
@@ -124,6 +194,188 @@ TYPED_TEST(FobTest, BEH_EncryptAndDecrypt) {
   EXPECT_THROW(typename TestFixture::Fob(encrypted_fob, symm_key, symm_iv), common_error);
 }
 
+TYPED_TEST(FobTest, BEH_KeySize) {
+  typename TestFixture::Fob fob(CreateFob<TypeParam>());
+  EXPECT_EQ(static_cast<unsigned>(detail::KeySize<TypeParam>::kBits),
+            fob.public_key().GetModulus().BitCount());
+  EXPECT_EQ(static_cast<unsigned>(detail::KeySize<TypeParam>::kBits),
+            fob.private_key().GetModulus().BitCount());
+}
+
+TEST(FobKeysTest, BEH_KeysMatch) {
+  asymm::Keys keys(asymm::GenerateKeyPair());
+  asymm::Keys other_keys(asymm::GenerateKeyPair());
+  EXPECT_TRUE(detail::RsaPssPolicy::KeysMatch(keys));
+  EXPECT_TRUE(detail::RsaPssPolicy::KeysMatch(other_keys));
+
+  asymm::Keys mixed_keys;
+  mixed_keys.private_key = keys.private_key;
+  mixed_keys.public_key = other_keys.public_key;
+  EXPECT_FALSE(detail::RsaPssPolicy::KeysMatch(mixed_keys));
+  mixed_keys.private_key = other_keys.private_key;
+  mixed_keys.public_key = keys.public_key;
+  EXPECT_FALSE(detail::RsaPssPolicy::KeysMatch(mixed_keys));
+}
+
+TEST(FobKeysTest, BEH_KeysMatchRejectsTamperedPrivateKey) {
+  using CryptoPP::Integer;
+  const asymm::Keys keys(asymm::GenerateKeyPair());
+  const asymm::PrivateKey& original(keys.private_key);
+  const Integer& p(original.GetPrime1());
+  const Integer& q(original.GetPrime2());
+  const Integer& d(original.GetPrivateExponent());
+
+  // Each case keeps the modulus and public exponent, so only the private key's own consistency
+  // checks can reject it.
+  auto tampered = [&](const std::function<void(asymm::PrivateKey&)>& tamper) {
+    asymm::Keys tampered_keys(keys);
+    tamper(tampered_keys.private_key);
+    return tampered_keys;
+  };
+  EXPECT_TRUE(detail::RsaPssPolicy::KeysMatch(tampered([](asymm::PrivateKey&) {})));
+
+  // p * q != n
+  EXPECT_FALSE(detail::RsaPssPolicy::KeysMatch(
+      tampered([&](asymm::PrivateKey& key) { key.SetPrime1(p + Integer::Two()); })));
+  EXPECT_FALSE(detail::RsaPssPolicy::KeysMatch(
+      tampered([&](asymm::PrivateKey& key) { key.SetPrime2(q + Integer::Two()); })));
+  // e * d != 1 mod lcm(p - 1, q - 1), with the CRT exponents made consistent with the altered d
+  EXPECT_FALSE(detail::RsaPssPolicy::KeysMatch(tampered([&](asymm::PrivateKey& key) {
+    const Integer altered_d(d + Integer::One());
+    key.SetPrivateExponent(altered_d);
+    key.SetModPrime1PrivateExponent(altered_d % (p - Integer::One()));
+    key.SetModPrime2PrivateExponent(altered_d % (q - Integer::One()));
+  })));
+  // Each CRT value
+  EXPECT_FALSE(detail::RsaPssPolicy::KeysMatch(tampered([&](asymm::PrivateKey& key) {
+    key.SetModPrime1PrivateExponent(original.GetModPrime1PrivateExponent() + Integer::One());
+  })));
+  EXPECT_FALSE(detail::RsaPssPolicy::KeysMatch(tampered([&](asymm::PrivateKey& key) {
+    key.SetModPrime2PrivateExponent(original.GetModPrime2PrivateExponent() + Integer::One());
+  })));
+  EXPECT_FALSE(detail::RsaPssPolicy::KeysMatch(tampered([&](asymm::PrivateKey& key) {
+    key.SetMultiplicativeInverseOfPrime2ModPrime1(
+        original.GetMultiplicativeInverseOfPrime2ModPrime1() + Integer::One());
+  })));
+}
+
+TEST(FobPolicyTest, BEH_CustomSignaturePolicy) {
+  using CountingFob = detail::Fob<CountingTag>;
+  using PublicCountingFob = detail::PublicFob<CountingTag>;
+  static_assert(std::is_same<CountingFob::Policy, CountingPolicy>::value,
+                "The specialised SignaturePolicy should be used.");
+  CountingPolicy::sign_count = 0;
+  CountingPolicy::check_count = 0;
+
+  CountingFob fob;
+  EXPECT_EQ(1, CountingPolicy::sign_count);
+  EXPECT_EQ(0, CountingPolicy::check_count);
+  EXPECT_EQ(1536U, fob.public_key().GetModulus().BitCount());
+
+  crypto::AES256Key symm_key(RandomString(crypto::AES256_KeySize));
+  crypto::AES256InitialisationVector symm_iv(RandomString(crypto::AES256_IVSize));
+  CountingFob decrypted_fob(fob.Encrypt(symm_key, symm_iv), symm_key, symm_iv);
+  EXPECT_TRUE(Equal(fob, decrypted_fob));
+  EXPECT_EQ(1, CountingPolicy::check_count);
+
+  PublicCountingFob public_fob(fob);
+  PublicCountingFob parsed_public_fob(public_fob.name(), public_fob.Serialise());
+  EXPECT_TRUE(Equal(public_fob, parsed_public_fob));
+  EXPECT_EQ(1, CountingPolicy::sign_count);
+  EXPECT_EQ(2, CountingPolicy::check_count);
+}
+
+TEST(FobKeyChainTest, FUNC_GenerateKeyChains) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_Test_Passport"));
+  const boost::filesystem::path kFilePath(*test_path / "keychains.dat");
+  const std::size_t kCount(5);
+  ASSERT_TRUE(detail::GenerateKeyChains(kFilePath, kCount, 3));
+  std::vector<detail::AnmaidToPmid> keychains(detail::ReadKeyChainList(kFilePath));
+  ASSERT_EQ(kCount, keychains.size());
+  for (std::size_t i(1); i < kCount; ++i) {
+    EXPECT_FALSE(Equal(keychains[0].anmaid, keychains[i].anmaid));
+    EXPECT_FALSE(Equal(keychains[0].pmid, keychains[i].pmid));
+  }
+
+  // Generating none should still produce a readable file
+  ASSERT_TRUE(detail::GenerateKeyChains(kFilePath, 0));
+  EXPECT_TRUE(detail::ReadKeyChainList(kFilePath).empty());
+}
+
+TEST(FobKeyChainTest, FUNC_KeyListReader) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_Test_Passport"));
+  const boost::filesystem::path kKeyChainsPath(*test_path / "keychains.dat");
+  const boost::filesystem::path kPmidsPath(*test_path / "pmids.dat");
+  const std::size_t kCount(3);
+
+  // Versioned format
+  ASSERT_TRUE(detail::GenerateKeyChains(kKeyChainsPath, kCount));
+  detail::KeyChainListReader keychain_reader(kKeyChainsPath);
+  ASSERT_EQ(kCount, keychain_reader.size());
+  std::vector<detail::AnmaidToPmid> keychains(detail::ReadKeyChainList(kKeyChainsPath));
+  ASSERT_EQ(kCount, keychains.size());
+  for (std::size_t i(kCount); i > 0; --i)
+    EXPECT_TRUE(Equal(keychains[i - 1].pmid, keychain_reader.Get(i - 1).pmid));
+  EXPECT_THROW(keychain_reader.Get(kCount), common_error);
+  EXPECT_THROW(detail::PmidListReader reader(kKeyChainsPath), common_error);
+
+  // Corrupting one entry only affects that entry
+  std::string contents(ReadFile(kKeyChainsPath).string());
+  contents[contents.size() / 2] ^= 1;
+  ASSERT_TRUE(WriteFile(kKeyChainsPath, contents));
+  detail::KeyChainListReader corrupted_reader(kKeyChainsPath);
+  std::size_t failures(0);
+  for (std::size_t i(0); i < kCount; ++i) {
+    try {
+      EXPECT_TRUE(Equal(keychains[i].anmaid, corrupted_reader.Get(i).anmaid));
+    } catch (const common_error&) {
+      ++failures;
+    }
+  }
+  EXPECT_EQ(1U, failures);
+
+  std::vector<detail::Fob<detail::PmidTag>> pmids;
+  for (const auto& keychain : keychains)
+    pmids.push_back(keychain.pmid);
+  ASSERT_TRUE(detail::WritePmidList(kPmidsPath, pmids));
+  detail::PmidListReader pmid_reader(kPmidsPath);
+  ASSERT_EQ(kCount, pmid_reader.size());
+  EXPECT_TRUE(Equal(pmids[1], pmid_reader.Get(1)));
+  EXPECT_THROW(pmid_reader.Get(kCount), common_error);
+  EXPECT_THROW(detail::KeyChainListReader reader(kPmidsPath), common_error);
+
+  // Unversioned format, as written by earlier versions of WritePmidList
+  crypto::AES256Key symm_key(std::string(crypto::AES256_KeySize, 0));
+  crypto::AES256InitialisationVector symm_iv(std::string(crypto::AES256_IVSize, 0));
+  OutputVectorStream binary_output_stream;
+  Serialise(binary_output_stream, static_cast<std::uint32_t>(pmids.size()));
+  for (const auto& pmid : pmids)
+    Serialise(binary_output_stream, pmid.Encrypt(symm_key, symm_iv));
+  SerialisedData legacy_contents(binary_output_stream.vector());
+  ASSERT_TRUE(WriteFile(kPmidsPath, std::string(legacy_contents.begin(), legacy_contents.end())));
+  detail::PmidListReader legacy_reader(kPmidsPath);
+  ASSERT_EQ(kCount, legacy_reader.size());
+  EXPECT_TRUE(Equal(pmids[2], legacy_reader.Get(2)));
+  EXPECT_THROW(legacy_reader.Get(kCount), common_error);
+  std::vector<detail::Fob<detail::PmidTag>> legacy_pmids(detail::ReadPmidList(kPmidsPath));
+  ASSERT_EQ(kCount, legacy_pmids.size());
+  EXPECT_TRUE(Equal(pmids[0], legacy_pmids[0]));
+}
+
+TEST(FobKeyChainTest, BEH_WriteLargePmidList) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_Test_Passport"));
+  const boost::filesystem::path kFilePath(*test_path / "pmids.dat");
+  // Enough entries that the writer's buffer is flushed several times
+  std::vector<detail::Fob<detail::PmidTag>> pmids(200, CreateFob<detail::PmidTag>());
+  ASSERT_TRUE(detail::WritePmidList(kFilePath, pmids));
+  detail::PmidListReader reader(kFilePath);
+  ASSERT_EQ(pmids.size(), reader.size());
+  EXPECT_TRUE(Equal(pmids.front(), reader.Get(0)));
+  EXPECT_TRUE(Equal(pmids.back(), reader.Get(reader.size() - 1)));
+
+  EXPECT_FALSE(detail::WritePmidList(*test_path / "missing" / "pmids.dat", pmids));
+}
+
 }  // namespace test
 
 }  // namespace passport
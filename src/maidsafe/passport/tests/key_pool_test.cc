@@ -0,0 +1,118 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/passport/key_pool.h"
+
+#include <chrono>
+#include <thread>
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/passport/passport.h"
+#include "maidsafe/passport/tests/test_utils.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace test {
+
+namespace {
+
+bool WaitUntilFull(const KeyPool& key_pool, std::size_t depth) {
+  for (int i(0); i < 600; ++i) {
+    if (key_pool.GetStats().available == depth)
+      return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  return false;
+}
+
+}  // unnamed namespace
+
+TEST(KeyPoolTest, BEH_InvalidParameters) {
+  EXPECT_THROW(KeyPool(0, 1), maidsafe_error);
+  EXPECT_THROW(KeyPool(1, 0), maidsafe_error);
+  EXPECT_THROW(KeyPool(1, 1, detail::RsaPssPolicy::kMinimumKeyBits - 1), maidsafe_error);
+}
+
+TEST(KeyPoolTest, FUNC_HitsAndMisses) {
+  const std::size_t kDepth(3);
+  KeyPool key_pool(kDepth, 2);
+  ASSERT_TRUE(WaitUntilFull(key_pool, kDepth));
+  KeyPool::Stats stats(key_pool.GetStats());
+  EXPECT_EQ(0U, stats.hits);
+  EXPECT_EQ(0U, stats.misses);
+
+  // Drain the pool and ask for one more than it holds.
+  for (std::size_t i(0); i < kDepth + 1; ++i)
+    key_pool.Get();
+  stats = key_pool.GetStats();
+  EXPECT_EQ(kDepth + 1, stats.hits + stats.misses);
+  EXPECT_GE(stats.hits, kDepth);
+
+  // The workers should refill the pool.
+  EXPECT_TRUE(WaitUntilFull(key_pool, kDepth));
+}
+
+TEST(KeyPoolTest, FUNC_KeySizes) {
+  const unsigned kPoolKeyBits(1536);
+  KeyPool key_pool(1, 1, kPoolKeyBits);
+  ASSERT_TRUE(WaitUntilFull(key_pool, 1));
+  EXPECT_EQ(kPoolKeyBits, key_pool.Get().public_key.GetModulus().BitCount());
+  EXPECT_EQ(1U, key_pool.GetStats().hits);
+
+  // Requests for any other size are generated on demand.
+  ASSERT_TRUE(WaitUntilFull(key_pool, 1));
+  EXPECT_EQ(detail::kDefaultKeyBits,
+            key_pool.Get<detail::MaidTag>().public_key.GetModulus().BitCount());
+  KeyPool::Stats stats(key_pool.GetStats());
+  EXPECT_EQ(1U, stats.hits);
+  EXPECT_EQ(1U, stats.misses);
+  EXPECT_EQ(1U, stats.available);
+
+  // Fobs reject keys of the wrong size.
+  EXPECT_THROW(Anmaid{key_pool.Get()}, maidsafe_error);
+}
+
+TEST(KeyPoolTest, FUNC_CreateKeysAndSigners) {
+  KeyPool key_pool(2, 1);
+  crypto::AES256Key symm_key(RandomString(crypto::AES256_KeySize));
+  crypto::AES256InitialisationVector symm_iv(RandomString(crypto::AES256_IVSize));
+
+  MaidAndSigner maid_and_signer(CreateMaidAndSigner(key_pool));
+  EXPECT_TRUE(Equal(maid_and_signer.first,
+                    Maid(maid_and_signer.first.Encrypt(symm_key, symm_iv), symm_key, symm_iv)));
+  EXPECT_TRUE(Equal(maid_and_signer.second, Anmaid(maid_and_signer.second.Encrypt(symm_key, symm_iv),
+                                                   symm_key, symm_iv)));
+
+  PmidAndSigner pmid_and_signer(CreatePmidAndSigner(key_pool));
+  EXPECT_TRUE(Equal(pmid_and_signer.first,
+                    Pmid(pmid_and_signer.first.Encrypt(symm_key, symm_iv), symm_key, symm_iv)));
+
+  MpidAndSigner mpid_and_signer(CreateMpidAndSigner(key_pool));
+  EXPECT_TRUE(Equal(mpid_and_signer.first,
+                    Mpid(mpid_and_signer.first.Encrypt(symm_key, symm_iv), symm_key, symm_iv)));
+}
+
+}  // namespace test
+
+}  // namespace passport
+
+}  // namespace maidsafe
@@ -0,0 +1,90 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/passport/detail/keys_and_signers.h"
+
+#include <string>
+#include <vector>
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/passport/tests/stand_in_key.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace test {
+
+using Key = StandInKey;
+using KeyAndSigner = StandInKeyAndSigner;
+
+TEST(KeysAndSignersTest, BEH_AddFindAndRemove) {
+  detail::KeysAndSigners<Key> keys_and_signers;
+  EXPECT_TRUE(keys_and_signers.empty());
+  std::vector<KeyAndSigner> added;
+  for (int i(0); i < 10; ++i) {
+    added.push_back(CreateStandInKeyAndSigner());
+    EXPECT_NO_THROW(keys_and_signers.Add(added.back()));
+  }
+  ASSERT_EQ(added.size(), keys_and_signers.size());
+
+  // Duplicate key or duplicate signer
+  KeyAndSigner duplicate_key(CreateStandInKeyAndSigner());
+  duplicate_key.first = added[3].first;
+  EXPECT_THROW(keys_and_signers.Add(duplicate_key), maidsafe_error);
+  KeyAndSigner duplicate_signer(CreateStandInKeyAndSigner());
+  duplicate_signer.second = added[7].second;
+  EXPECT_THROW(keys_and_signers.Add(duplicate_signer), maidsafe_error);
+  EXPECT_EQ(added.size(), keys_and_signers.size());
+
+  // Find
+  for (const auto& key_and_signer : added) {
+    const KeyAndSigner* found(keys_and_signers.Find(key_and_signer.first.name()));
+    ASSERT_NE(nullptr, found);
+    EXPECT_EQ(key_and_signer.second.name(), found->second.name());
+  }
+  EXPECT_EQ(nullptr, keys_and_signers.Find(CreateStandInKeyAndSigner().first.name()));
+
+  // Remove preserves the order of the remaining elements
+  EXPECT_EQ(added[4].second.name(), keys_and_signers.Remove(added[4].first.name()).name());
+  EXPECT_THROW(keys_and_signers.Remove(added[4].first.name()), maidsafe_error);
+  EXPECT_EQ(nullptr, keys_and_signers.Find(added[4].first.name()));
+  added.erase(added.begin() + 4);
+  ASSERT_EQ(added.size(), keys_and_signers.size());
+  auto added_itr(std::begin(added));
+  for (const auto& key_and_signer : keys_and_signers)
+    EXPECT_EQ((added_itr++)->first.name(), key_and_signer.first.name());
+
+  // The removed signer can be reused
+  KeyAndSigner reused_signer(CreateStandInKeyAndSigner());
+  reused_signer.second = keys_and_signers.Remove(added[0].first.name());
+  EXPECT_NO_THROW(keys_and_signers.Add(reused_signer));
+
+  // Moving keeps the index valid
+  detail::KeysAndSigners<Key> moved(std::move(keys_and_signers));
+  EXPECT_NE(nullptr, moved.Find(reused_signer.first.name()));
+  EXPECT_EQ(reused_signer.second.name(), moved.Remove(reused_signer.first.name()).name());
+}
+
+}  // namespace test
+
+}  // namespace passport
+
+}  // namespace maidsafe
@@ -0,0 +1,117 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/passport/metrics.h"
+
+#include <numeric>
+#include <string>
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/passport/passport.h"
+#include "maidsafe/passport/types.h"
+#include "maidsafe/passport/tests/user_credentials.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace test {
+
+namespace {
+
+std::uint64_t Count(Operation operation) { return GetMetrics()[operation].count; }
+
+std::uint64_t HistogramTotal(const OperationMetrics& metrics) {
+  return std::accumulate(std::begin(metrics.latency_histogram),
+                         std::end(metrics.latency_histogram), std::uint64_t(0));
+}
+
+}  // unnamed namespace
+
+TEST(MetricsTest, BEH_DisabledByDefault) {
+  ASSERT_FALSE(MetricsEnabled());
+  ResetMetrics();
+  Anmaid anmaid;
+  Maid maid(anmaid);
+  Metrics metrics(GetMetrics());
+  for (const auto& operation_metrics : metrics.operations) {
+    EXPECT_EQ(0U, operation_metrics.count);
+    EXPECT_EQ(0U, operation_metrics.total_microseconds);
+    EXPECT_EQ(0U, HistogramTotal(operation_metrics));
+  }
+}
+
+TEST(MetricsTest, FUNC_RecordsOperations) {
+  EnableMetrics(true);
+  ResetMetrics();
+
+  Anpmid anpmid;
+  Pmid pmid(anpmid);
+  EXPECT_EQ(2U, Count(Operation::kKeyGeneration));
+  EXPECT_EQ(2U, Count(Operation::kCreateValidationToken));
+  EXPECT_EQ(0U, Count(Operation::kValidateToken));
+
+  crypto::AES256Key symm_key(RandomString(crypto::AES256_KeySize));
+  crypto::AES256InitialisationVector symm_iv(RandomString(crypto::AES256_IVSize));
+  Pmid decrypted_pmid(pmid.Encrypt(symm_key, symm_iv), symm_key, symm_iv);
+  EXPECT_EQ(1U, Count(Operation::kFobEncrypt));
+  EXPECT_EQ(1U, Count(Operation::kFobDecrypt));
+  EXPECT_EQ(1U, Count(Operation::kValidateToken));
+
+  PublicPmid public_pmid(pmid);
+  PublicPmid parsed_public_pmid(public_pmid.name(), public_pmid.Serialise());
+  EXPECT_EQ(1U, Count(Operation::kPublicFobParse));
+  EXPECT_EQ(2U, Count(Operation::kValidateToken));
+
+  Passport passport(CreateMaidAndSigner());
+  PassportSession session(CreateUserCredentials());
+  EXPECT_EQ(1U, Count(Operation::kSessionCreation));
+  crypto::CipherText encrypted_passport(passport.Encrypt(session));
+  EXPECT_EQ(1U, Count(Operation::kPassportSave));
+  Passport decrypted_passport(encrypted_passport, session);
+  EXPECT_EQ(1U, Count(Operation::kPassportLoad));
+
+  // Every recorded operation appears in exactly one latency bucket.
+  Metrics metrics(GetMetrics());
+  for (const auto& operation_metrics : metrics.operations)
+    EXPECT_EQ(operation_metrics.count, HistogramTotal(operation_metrics));
+  EXPECT_GT(metrics[Operation::kKeyGeneration].total_microseconds, 0U);
+
+  EnableMetrics(false);
+  Anmaid anmaid;
+  EXPECT_EQ(metrics[Operation::kKeyGeneration].count, Count(Operation::kKeyGeneration));
+
+  ResetMetrics();
+  for (const auto& operation_metrics : GetMetrics().operations) {
+    EXPECT_EQ(0U, operation_metrics.count);
+    EXPECT_EQ(0U, HistogramTotal(operation_metrics));
+  }
+}
+
+TEST(MetricsTest, BEH_OperationNames) {
+  EXPECT_EQ(std::string("KeyGeneration"), OperationName(Operation::kKeyGeneration));
+  EXPECT_EQ(std::string("PassportLockWait"), OperationName(Operation::kPassportLockWait));
+}
+
+}  // namespace test
+
+}  // namespace passport
+
+}  // namespace maidsafe
@@ -28,9 +28,12 @@
 #include "maidsafe/common/test.h"
 #include "maidsafe/common/utils.h"
 #include "maidsafe/common/authentication/user_credentials.h"
+#include "maidsafe/common/authentication/user_credential_utils.h"
+#include "maidsafe/common/serialisation/serialisation.h"
 
 #include "maidsafe/passport/detail/fob.h"
 #include "maidsafe/passport/tests/test_utils.h"
+#include "maidsafe/passport/tests/user_credentials.h"
 
 namespace maidsafe {
 
@@ -81,15 +84,42 @@ TEST(PassportTest, BEH_FreeFunctions) {
   EXPECT_THROW(maidsafe::passport::DecryptPmid(encrypted_pmid, symm_key, symm_iv), maidsafe_error);
 }
 
-authentication::UserCredentials CreateUserCredentials() {
-  authentication::UserCredentials user_credentials;
-  user_credentials.keyword = maidsafe::make_unique<authentication::UserCredentials::Keyword>(
-      RandomAlphaNumericString((RandomUint32() % 100) + 1));
-  user_credentials.pin =
-      maidsafe::make_unique<authentication::UserCredentials::Pin>(std::to_string(RandomUint32()));
-  user_credentials.password = maidsafe::make_unique<authentication::UserCredentials::Password>(
-      RandomAlphaNumericString((RandomUint32() % 100) + 1));
-  return user_credentials;
+template <typename KeyAndSigner>
+testing::AssertionResult SignedBySigner(const KeyAndSigner& key_and_signer) {
+  if (!asymm::CheckSignature(asymm::PlainText(asymm::EncodeKey(key_and_signer.first.public_key())),
+                             key_and_signer.first.validation_token().signature_of_public_key,
+                             key_and_signer.second.public_key())) {
+    return testing::AssertionFailure() << "Key not signed by signer.";
+  }
+  return testing::AssertionSuccess();
+}
+
+TEST(PassportTest, FUNC_CreateKeysAndSignersAsync) {
+  auto maid_future(CreateMaidAndSignerAsync());
+  auto pmid_future(CreatePmidAndSignerAsync());
+  auto mpid_future(CreateMpidAndSignerAsync());
+  EXPECT_TRUE(SignedBySigner(maid_future.get()));
+  EXPECT_TRUE(SignedBySigner(pmid_future.get()));
+  EXPECT_TRUE(SignedBySigner(mpid_future.get()));
+
+  // Executor which runs tasks inline
+  Executor inline_executor([](std::function<void()> task) { task(); });
+  EXPECT_TRUE(SignedBySigner(CreateMaidAndSignerAsync(inline_executor).get()));
+  EXPECT_TRUE(SignedBySigner(CreatePmidAndSignerAsync(inline_executor).get()));
+  EXPECT_TRUE(SignedBySigner(CreateMpidAndSignerAsync(inline_executor).get()));
+
+  // Executor which runs tasks on separate threads
+  std::vector<std::future<void>> tasks;
+  std::mutex tasks_mutex;
+  Executor async_executor([&](std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(tasks_mutex);
+    tasks.emplace_back(std::async(std::launch::async, std::move(task)));
+  });
+  EXPECT_TRUE(SignedBySigner(CreateMaidAndSignerAsync(async_executor).get()));
+  EXPECT_TRUE(SignedBySigner(CreatePmidAndSignerAsync(async_executor).get()));
+  EXPECT_TRUE(SignedBySigner(CreateMpidAndSignerAsync(async_executor).get()));
+  for (auto& task : tasks)
+    EXPECT_NO_THROW(task.get());
 }
 
 TEST(PassportTest, FUNC_ConstructorsSettersAndGetters) {
@@ -226,6 +256,14 @@ TEST(PassportTest, FUNC_RemoveAndReplaceKeys) {
                maidsafe_error);
   EXPECT_THROW(passport.Encrypt(CreateUserCredentials()), maidsafe_error);
 
+  // Find
+  for (const auto& pmid_and_signer : pmids_and_signers)
+    EXPECT_TRUE(Equal(pmid_and_signer.first, passport.FindPmid(pmid_and_signer.first.name())));
+  for (const auto& mpid_and_signer : mpids_and_signers)
+    EXPECT_TRUE(Equal(mpid_and_signer.first, passport.FindMpid(mpid_and_signer.first.name())));
+  EXPECT_THROW(passport.FindPmid(Pmid::Name{mpids_and_signers[0].first.name().value}),
+               maidsafe_error);
+
   // Remove Pmids
   Anpmid anpmid{passport.RemoveKeyAndSigner(pmids_and_signers[1].first)};
   EXPECT_TRUE(Equal(anpmid, pmids_and_signers[1].second));
@@ -242,6 +280,7 @@ TEST(PassportTest, FUNC_RemoveAndReplaceKeys) {
   anpmid = passport.RemoveKeyAndSigner(pmids_and_signers[0].first);
   EXPECT_TRUE(Equal(anpmid, pmids_and_signers[0].second));
   EXPECT_TRUE(passport.GetPmids().empty());
+  EXPECT_THROW(passport.FindPmid(pmids_and_signers[0].first.name()), maidsafe_error);
 
   // Remove Mpids
   Anmpid anmpid{passport.RemoveKeyAndSigner(mpids_and_signers[0].first)};
@@ -261,6 +300,35 @@ TEST(PassportTest, FUNC_RemoveAndReplaceKeys) {
   EXPECT_TRUE(passport.GetMpids().empty());
 }
 
+TEST(PassportTest, FUNC_ForEachKey) {
+  Passport passport{CreateMaidAndSigner()};
+  std::size_t count{0};
+  passport.ForEachPmid([&](const Pmid&) { ++count; });
+  passport.ForEachMpid([&](const Mpid&) { ++count; });
+  EXPECT_EQ(0U, count);
+
+  std::vector<PmidAndSigner> pmids_and_signers;
+  std::vector<MpidAndSigner> mpids_and_signers;
+  for (size_t i(0); i < 3; ++i) {
+    pmids_and_signers.emplace_back(CreatePmidAndSigner());
+    passport.AddKeyAndSigner(pmids_and_signers.back());
+    mpids_and_signers.emplace_back(CreateMpidAndSigner());
+    passport.AddKeyAndSigner(mpids_and_signers.back());
+  }
+
+  passport.ForEachPmid([&](const Pmid& pmid) {
+    ASSERT_LT(count, pmids_and_signers.size());
+    EXPECT_TRUE(Equal(pmids_and_signers[count++].first, pmid));
+  });
+  EXPECT_EQ(pmids_and_signers.size(), count);
+  count = 0;
+  passport.ForEachMpid([&](const Mpid& mpid) {
+    ASSERT_LT(count, mpids_and_signers.size());
+    EXPECT_TRUE(Equal(mpids_and_signers[count++].first, mpid));
+  });
+  EXPECT_EQ(mpids_and_signers.size(), count);
+}
+
 TEST(PassportTest, FUNC_Encrypt) {
   MaidAndSigner maid_and_signer{CreateMaidAndSigner()};
   Passport passport{maid_and_signer};
@@ -334,6 +402,206 @@ TEST(PassportTest, FUNC_Encrypt) {
     EXPECT_TRUE(Equal(*mpids_itr++, (*mpids_and_signers_itr++).first));
 }
 
+TEST(PassportTest, FUNC_Session) {
+  MaidAndSigner maid_and_signer{CreateMaidAndSigner()};
+  Passport passport{maid_and_signer};
+  authentication::UserCredentials user_credentials{CreateUserCredentials()};
+  PassportSession session{user_credentials};
+
+  // Saves via the session and via the credentials must be interchangeable
+  PmidAndSigner pmid_and_signer{CreatePmidAndSigner()};
+  passport.AddKeyAndSigner(pmid_and_signer);
+  crypto::CipherText encrypted_passport{passport.Encrypt(session)};
+  EXPECT_TRUE(encrypted_passport == passport.Encrypt(user_credentials));
+  Passport decrypted{encrypted_passport, user_credentials};
+  EXPECT_TRUE(Equal(decrypted.GetMaid(), maid_and_signer.first));
+  ASSERT_EQ(1U, decrypted.GetPmids().size());
+  EXPECT_TRUE(Equal(decrypted.GetPmids().front(), pmid_and_signer.first));
+
+  Passport decrypted_via_session{passport.Encrypt(user_credentials), session};
+  EXPECT_TRUE(Equal(decrypted_via_session.GetMaid(), maid_and_signer.first));
+
+  // A session for different credentials can't decrypt
+  PassportSession other_session{CreateUserCredentials()};
+  EXPECT_THROW(Passport(encrypted_passport, other_session), maidsafe_error);
+
+  // Null credential fields
+  user_credentials.pin.reset();
+  EXPECT_THROW(PassportSession{user_credentials}, maidsafe_error);
+}
+
+TEST(PassportTest, FUNC_LazyDecryption) {
+  MaidAndSigner maid_and_signer{CreateMaidAndSigner()};
+  Passport passport{maid_and_signer};
+  std::vector<PmidAndSigner> pmids_and_signers;
+  for (int i(0); i < 3; ++i) {
+    pmids_and_signers.push_back(CreatePmidAndSigner());
+    passport.AddKeyAndSigner(pmids_and_signers.back());
+  }
+  MpidAndSigner mpid_and_signer{CreateMpidAndSigner()};
+  passport.AddKeyAndSigner(mpid_and_signer);
+  PassportSession session{CreateUserCredentials()};
+  crypto::CipherText encrypted_passport{passport.Encrypt(session)};
+
+  // Re-encrypting with the same session writes the pending keys as they are
+  Passport lazy{encrypted_passport, session, DecryptionMode::kLazy};
+  EXPECT_TRUE(Equal(lazy.GetMaid(), maid_and_signer.first));
+  EXPECT_TRUE(encrypted_passport == lazy.Encrypt(session));
+
+  // Re-encrypting with a different session has to decrypt them first
+  PassportSession other_session{CreateUserCredentials()};
+  Passport lazy_for_other{encrypted_passport, session, DecryptionMode::kLazy};
+  Passport reencrypted{lazy_for_other.Encrypt(other_session), other_session};
+  ASSERT_EQ(pmids_and_signers.size(), reencrypted.GetPmids().size());
+  ASSERT_EQ(1U, reencrypted.GetMpids().size());
+  EXPECT_TRUE(Equal(reencrypted.GetMpids().front(), mpid_and_signer.first));
+
+  // Each accessor decrypts on first use
+  std::vector<Pmid> pmids(lazy.GetPmids());
+  ASSERT_EQ(pmids_and_signers.size(), pmids.size());
+  for (std::size_t i(0); i < pmids.size(); ++i)
+    EXPECT_TRUE(Equal(pmids[i], pmids_and_signers[i].first));
+  Passport lazy_find{encrypted_passport, session, DecryptionMode::kLazy};
+  EXPECT_TRUE(Equal(lazy_find.FindMpid(mpid_and_signer.first.name()), mpid_and_signer.first));
+  Passport lazy_remove{encrypted_passport, session, DecryptionMode::kLazy};
+  EXPECT_TRUE(Equal(lazy_remove.RemoveKeyAndSigner(pmids_and_signers[1].first),
+                    pmids_and_signers[1].second));
+  EXPECT_EQ(pmids_and_signers.size() - 1, lazy_remove.GetPmids().size());
+  Passport lazy_add{encrypted_passport, session, DecryptionMode::kLazy};
+  EXPECT_THROW(lazy_add.AddKeyAndSigner(pmids_and_signers[0]), maidsafe_error);
+  lazy_add.AddKeyAndSigner(CreatePmidAndSigner());
+  EXPECT_EQ(pmids_and_signers.size() + 1, lazy_add.GetPmids().size());
+  Passport reloaded{lazy_add.Encrypt(session), session};
+  EXPECT_EQ(pmids_and_signers.size() + 1, reloaded.GetPmids().size());
+  EXPECT_EQ(1U, reloaded.GetMpids().size());
+}
+
+TEST(PassportTest, FUNC_LazyDecryptionFailure) {
+  MaidAndSigner maid_and_signer{CreateMaidAndSigner()};
+  Passport passport{maid_and_signer};
+  for (int i(0); i < 3; ++i)
+    passport.AddKeyAndSigner(CreatePmidAndSigner());
+  MpidAndSigner mpid_and_signer{CreateMpidAndSigner()};
+  passport.AddKeyAndSigner(mpid_and_signer);
+  authentication::UserCredentials user_credentials{CreateUserCredentials()};
+  PassportSession session{user_credentials};
+
+  // Rebuild the encrypted passport with one Pmid replaced by validly encrypted garbage, so that
+  // only decrypting the pending Pmids can fail.
+  crypto::SecurePassword secure_password{authentication::CreateSecurePassword(user_credentials)};
+  crypto::AES256Key symm_key{authentication::DeriveSymmEncryptKey(secure_password)};
+  crypto::AES256InitialisationVector symm_iv{authentication::DeriveSymmEncryptIv(secure_password)};
+  std::string contents{authentication::Obfuscate(user_credentials,
+                                                 crypto::SymmDecrypt(passport.Encrypt(session),
+                                                                     symm_key, symm_iv)).string()};
+  InputVectorStream input_stream{SerialisedData(contents.begin(), contents.end())};
+  crypto::CipherText encrypted_maid{Parse<crypto::CipherText>(input_stream)};
+  crypto::CipherText encrypted_anmaid{Parse<crypto::CipherText>(input_stream)};
+  std::uint32_t pmid_count{Parse<std::uint32_t>(input_stream)};
+  std::uint32_t mpid_count{Parse<std::uint32_t>(input_stream)};
+  ASSERT_EQ(3U, pmid_count);
+  ASSERT_EQ(1U, mpid_count);
+  OutputVectorStream output_stream;
+  Serialise(output_stream, encrypted_maid.data.string(), encrypted_anmaid.data.string(), pmid_count,
+            mpid_count);
+  for (std::uint32_t i(0); i < pmid_count + mpid_count; ++i) {
+    crypto::CipherText encrypted_key{Parse<crypto::CipherText>(input_stream)};
+    crypto::CipherText encrypted_signer{Parse<crypto::CipherText>(input_stream)};
+    if (i == 1)
+      encrypted_key = crypto::SymmEncrypt(crypto::PlainText{RandomString(100)}, symm_key, symm_iv);
+    Serialise(output_stream, encrypted_key, encrypted_signer);
+  }
+  SerialisedData corrupted_contents(output_stream.vector());
+  crypto::CipherText corrupted{crypto::SymmEncrypt(
+      authentication::Obfuscate(
+          user_credentials,
+          NonEmptyString{std::string(corrupted_contents.begin(), corrupted_contents.end())}),
+      symm_key, symm_iv)};
+
+  // The eager load fails up front
+  EXPECT_THROW(Passport(corrupted, session), maidsafe_error);
+
+  // The lazy load only fails when the Pmids are first needed, and keeps failing after that
+  Passport lazy{corrupted, session, DecryptionMode::kLazy};
+  try {
+    lazy.GetPmids();
+    FAIL() << "GetPmids should have thrown";
+  } catch (const maidsafe_error& error) {
+    EXPECT_EQ(make_error_code(CommonErrors::parsing_error), error.code());
+  }
+  EXPECT_THROW(lazy.GetPmids(), maidsafe_error);
+  Passport lazy_for_each{corrupted, session, DecryptionMode::kLazy};
+  int visited{0};
+  try {
+    lazy_for_each.ForEachPmid([&](const Pmid&) { ++visited; });
+    FAIL() << "ForEachPmid should have thrown";
+  } catch (const maidsafe_error& error) {
+    EXPECT_EQ(make_error_code(CommonErrors::parsing_error), error.code());
+  }
+  EXPECT_EQ(0, visited);
+
+  // The rest of the passport is still usable
+  for (const Passport* failed : {&lazy, &lazy_for_each}) {
+    EXPECT_TRUE(Equal(failed->GetMaid(), maid_and_signer.first));
+    std::vector<Mpid> mpids(failed->GetMpids());
+    ASSERT_EQ(1U, mpids.size());
+    EXPECT_TRUE(Equal(mpids.front(), mpid_and_signer.first));
+    crypto::CipherText reencrypted;
+    EXPECT_NO_THROW(reencrypted = failed->Encrypt(session));
+    EXPECT_TRUE(corrupted == reencrypted);
+  }
+}
+
+TEST(PassportTest, FUNC_IncrementalEncrypt) {
+  Passport passport{CreateMaidAndSigner()};
+  PassportSession session{CreateUserCredentials()};
+  PassportSession other_session{CreateUserCredentials()};
+  std::vector<PmidAndSigner> pmids_and_signers;
+  auto check_saved_pmids = [&](const PassportSession& save_session) {
+    Passport decrypted{passport.Encrypt(save_session), save_session};
+    std::vector<Pmid> pmids(decrypted.GetPmids());
+    ASSERT_EQ(pmids_and_signers.size(), pmids.size());
+    for (std::size_t i(0); i < pmids.size(); ++i)
+      EXPECT_TRUE(Equal(pmids[i], pmids_and_signers[i].first));
+  };
+
+  // Adds and removes between saves, alternating the key material so the cached ciphertexts are
+  // sometimes reusable and sometimes not
+  for (int i(0); i < 4; ++i) {
+    pmids_and_signers.push_back(CreatePmidAndSigner());
+    passport.AddKeyAndSigner(pmids_and_signers.back());
+    check_saved_pmids(session);
+    check_saved_pmids(i % 2 == 0 ? session : other_session);
+  }
+  passport.RemoveKeyAndSigner(pmids_and_signers[1].first);
+  pmids_and_signers.erase(pmids_and_signers.begin() + 1);
+  check_saved_pmids(session);
+  pmids_and_signers.push_back(CreatePmidAndSigner());
+  passport.AddKeyAndSigner(pmids_and_signers.back());
+  check_saved_pmids(session);
+
+  // A re-save of a freshly decrypted passport is byte-for-byte the same
+  crypto::CipherText encrypted_passport{passport.Encrypt(session)};
+  Passport decrypted{encrypted_passport, session};
+  EXPECT_TRUE(encrypted_passport == decrypted.Encrypt(session));
+}
+
+// A key removed and re-added with a different signer between saves mustn't be written out with the
+// old signer's cached ciphertext.
+TEST(PassportTest, FUNC_ReAddKeyWithDifferentSigner) {
+  Passport passport{CreateMaidAndSigner()};
+  PassportSession session{CreateUserCredentials()};
+  PmidAndSigner pmid_and_signer(CreatePmidAndSigner());
+  const Pmid::Signer other_anpmid(CreatePmidAndSigner().second);
+  passport.AddKeyAndSigner(pmid_and_signer);
+  passport.Encrypt(session);
+
+  passport.RemoveKeyAndSigner(pmid_and_signer.first);
+  passport.AddKeyAndSigner(std::make_pair(pmid_and_signer.first, other_anpmid));
+  Passport decrypted{passport.Encrypt(session), session};
+  EXPECT_TRUE(Equal(other_anpmid, decrypted.RemoveKeyAndSigner(pmid_and_signer.first)));
+}
+
 TEST(PassportTest, FUNC_ParallelAddsEncryptsAndRemoves) {
   MaidAndSigner maid_and_signer{CreateMaidAndSigner()};
   Passport passport{maid_and_signer};
@@ -18,10 +18,15 @@
 
 #include "maidsafe/passport/detail/public_fob.h"
 
+#include <future>
+#include <string>
+#include <vector>
+
 #include "maidsafe/common/test.h"
 #include "maidsafe/common/utils.h"
 #include "maidsafe/common/serialisation/serialisation.h"
 
+#include "maidsafe/passport/passport.h"
 #include "maidsafe/passport/types.h"
 #include "maidsafe/passport/tests/test_utils.h"
 
@@ -110,6 +115,12 @@ TYPED_TEST(PublicFobTest, BEH_SerialisationAndParsing) {
 
   typename TestFixture::PublicFob parsed_public_fob(public_fob.name(), valid);
   EXPECT_TRUE(Equal(public_fob, parsed_public_fob));
+  typename TestFixture::PublicFob parsed_from_buffer(
+      public_fob.name(), serialised_public_fob.data(), serialised_public_fob.size());
+  EXPECT_TRUE(Equal(public_fob, parsed_from_buffer));
+  EXPECT_THROW(typename TestFixture::PublicFob(public_fob.name(), serialised_public_fob.data(),
+                                               serialised_public_fob.size() / 2),
+               common_error);
 
   // Modfiy serialised data and try to parse
   ++serialised_public_fob[RandomUint32() % serialised_public_fob.size()];
@@ -138,6 +149,140 @@ TYPED_TEST(PublicFobTest, BEH_SerialisationAndParsing) {
       common_error);
 }
 
+TYPED_TEST(PublicFobTest, BEH_ParseSerialisedTypeAndBufferAlike) {
+  using PublicFob = typename TestFixture::PublicFob;
+  PublicFob public_fob{typename TestFixture::Fob(CreateFob<TypeParam>())};
+
+  SerialisedData bytes(Serialise(public_fob));
+  auto parse_both = [&](const SerialisedData& input) {
+    typename PublicFob::serialised_type serialised(
+        NonEmptyString(std::string(input.begin(), input.end())));
+    bool from_serialised_type_threw(false), from_buffer_threw(false);
+    PublicFob from_serialised_type, from_buffer;
+    try {
+      from_serialised_type = PublicFob(public_fob.name(), serialised);
+    } catch (const common_error&) {
+      from_serialised_type_threw = true;
+    }
+    try {
+      from_buffer = PublicFob(public_fob.name(), input.data(), input.size());
+    } catch (const common_error&) {
+      from_buffer_threw = true;
+    }
+    EXPECT_EQ(from_serialised_type_threw, from_buffer_threw);
+    if (!from_serialised_type_threw && !from_buffer_threw) {
+      EXPECT_TRUE(Equal(from_serialised_type, from_buffer));
+    }
+    return !from_buffer_threw;
+  };
+
+  EXPECT_TRUE(parse_both(bytes));
+  for (int i(0); i < 10; ++i) {
+    SerialisedData corrupted(bytes);
+    ++corrupted[RandomUint32() % corrupted.size()];
+    parse_both(corrupted);
+  }
+  EXPECT_FALSE(parse_both(SerialisedData(bytes.begin(), bytes.begin() + bytes.size() / 2)));
+}
+
+TYPED_TEST(PublicFobTest, BEH_SerialiseIsMemoised) {
+  using PublicFob = typename TestFixture::PublicFob;
+  PublicFob public_fob{typename TestFixture::Fob(CreateFob<TypeParam>())};
+  PublicFob copied_public_fob(public_fob);
+
+  // Concurrent first calls must all see the same, fully-formed result
+  std::vector<std::future<typename PublicFob::serialised_type>> futures;
+  for (int i(0); i < 4; ++i) {
+    futures.emplace_back(std::async(std::launch::async, [&, i] {
+      return (i % 2 == 0 ? public_fob : copied_public_fob).Serialise();
+    }));
+  }
+  const typename PublicFob::serialised_type serialised(public_fob.Serialise());
+  for (auto& future : futures)
+    EXPECT_EQ(serialised.data.string(), future.get().data.string());
+
+  SerialisedData expected(Serialise(public_fob));
+  EXPECT_EQ(std::string(expected.begin(), expected.end()), serialised.data.string());
+  EXPECT_TRUE(Equal(public_fob, PublicFob(public_fob.name(), serialised)));
+
+  // The result is independent of the fob's lifetime
+  typename PublicFob::serialised_type outlived(PublicFob(public_fob).Serialise());
+  EXPECT_EQ(serialised.data.string(), outlived.data.string());
+}
+
+TYPED_TEST(PublicFobTest, BEH_ParsingCache) {
+  using PublicFob = typename TestFixture::PublicFob;
+  auto serialise = [](const PublicFob& public_fob) {
+    SerialisedData serialised(Serialise(public_fob));
+    return typename PublicFob::serialised_type(
+        NonEmptyString(std::string(serialised.begin(), serialised.end())));
+  };
+  std::vector<PublicFob> public_fobs;
+  for (int i(0); i < 3; ++i)
+    public_fobs.emplace_back(CreateFob<TypeParam>());
+
+  // Disabled by default
+  detail::PublicFobCacheStats initial_stats(GetPublicKeyCacheStats<PublicFob>());
+  EXPECT_EQ(0U, initial_stats.capacity);
+  PublicFob parsed(public_fobs[0].name(), serialise(public_fobs[0]));
+  EXPECT_TRUE(Equal(public_fobs[0], parsed));
+  EXPECT_EQ(initial_stats.misses, GetPublicKeyCacheStats<PublicFob>().misses);
+
+  SetPublicKeyCacheCapacity<PublicFob>(2);
+  for (int i(0); i < 2; ++i) {
+    for (const auto& public_fob : public_fobs)
+      EXPECT_TRUE(Equal(public_fob, PublicFob(public_fob.name(), serialise(public_fob))));
+  }
+  // Capacity 2 with LRU eviction and 3 keys cycled means every lookup misses.
+  detail::PublicFobCacheStats stats(GetPublicKeyCacheStats<PublicFob>());
+  EXPECT_EQ(2U, stats.size);
+  EXPECT_EQ(initial_stats.misses + 6, stats.misses);
+  EXPECT_EQ(initial_stats.hits, stats.hits);
+
+  EXPECT_TRUE(Equal(public_fobs[2], PublicFob(public_fobs[2].name(), serialise(public_fobs[2]))));
+  stats = GetPublicKeyCacheStats<PublicFob>();
+  EXPECT_EQ(initial_stats.hits + 1, stats.hits);
+
+  // A cached fob parsed under a different name must still fail
+  EXPECT_THROW(PublicFob(public_fobs[1].name(), serialise(public_fobs[2])), common_error);
+  // Invalid fobs aren't cached
+  SerialisedData serialised(Serialise(public_fobs[2]));
+  ++serialised[RandomUint32() % serialised.size()];
+  typename PublicFob::serialised_type invalid(
+      NonEmptyString(std::string(serialised.begin(), serialised.end())));
+  EXPECT_THROW(PublicFob(public_fobs[2].name(), invalid), common_error);
+  EXPECT_THROW(PublicFob(public_fobs[2].name(), invalid), common_error);
+  EXPECT_EQ(2U, GetPublicKeyCacheStats<PublicFob>().size);
+
+  SetPublicKeyCacheCapacity<PublicFob>(0);
+  EXPECT_EQ(0U, GetPublicKeyCacheStats<PublicFob>().size);
+}
+
+TYPED_TEST(PublicFobTest, BEH_ParsePublicKeys) {
+  using PublicFob = typename TestFixture::PublicFob;
+  std::vector<PublicFob> public_fobs;
+  std::vector<std::pair<typename PublicFob::Name, typename PublicFob::serialised_type>> serialised;
+  for (int i(0); i < 6; ++i) {
+    public_fobs.emplace_back(CreateFob<TypeParam>());
+    serialised.emplace_back(public_fobs.back().name(), public_fobs.back().Serialise());
+  }
+  // Corrupt one entry and give another the wrong name
+  std::string corrupted(serialised[1].second->string());
+  corrupted[RandomUint32() % corrupted.size()] ^= 1;
+  serialised[1].second = typename PublicFob::serialised_type(NonEmptyString(corrupted));
+  serialised[4].first = public_fobs[3].name();
+
+  std::vector<PublicFob> parsed(ParsePublicKeys<PublicFob>(serialised, 3));
+  ASSERT_EQ(public_fobs.size(), parsed.size());
+  for (std::size_t i(0); i < parsed.size(); ++i) {
+    if (i == 1 || i == 4)
+      EXPECT_FALSE(parsed[i].IsInitialised());
+    else
+      EXPECT_TRUE(Equal(public_fobs[i], parsed[i]));
+  }
+  EXPECT_TRUE(ParsePublicKeys<PublicFob>({}).empty());
+}
+
 TYPED_TEST(PublicFobTest, BEH_DefaultConstructed) {
   typename TestFixture::PublicFob public_fob;
   EXPECT_FALSE(public_fob.IsInitialised());
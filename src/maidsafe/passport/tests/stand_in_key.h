@@ -0,0 +1,62 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_PASSPORT_TESTS_STAND_IN_KEY_H_
+#define MAIDSAFE_PASSPORT_TESTS_STAND_IN_KEY_H_
+
+#include "maidsafe/common/types.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/passport/detail/keys_and_signers.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace test {
+
+// Stand-ins for a key and its signer, so that KeysAndSigners can be tested and benchmarked at large
+// sizes without generating RSA keys; KeysAndSigners only uses their names.  Doesn't depend on
+// gtest, so is shared by the tests and the benchmarks.
+struct StandInSigner {
+  using Name = maidsafe::detail::Name<StandInSigner>;
+  Name name() const { return name_; }
+  Name name_;
+};
+
+struct StandInKey {
+  using Name = maidsafe::detail::Name<StandInKey>;
+  using Signer = StandInSigner;
+  Name name() const { return name_; }
+  Name name_;
+};
+
+using StandInKeyAndSigner = detail::KeysAndSigners<StandInKey>::KeyAndSigner;
+
+inline StandInKeyAndSigner CreateStandInKeyAndSigner() {
+  return StandInKeyAndSigner{StandInKey{StandInKey::Name{Identity{RandomString(64)}}},
+                             StandInSigner{StandInSigner::Name{Identity{RandomString(64)}}}};
+}
+
+}  // namespace test
+
+}  // namespace passport
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_PASSPORT_TESTS_STAND_IN_KEY_H_
@@ -0,0 +1,111 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/passport/tracing.h"
+
+#include <string>
+#include <thread>
+
+#include "boost/filesystem/operations.hpp"
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/passport/passport.h"
+#include "maidsafe/passport/types.h"
+#include "maidsafe/passport/tests/user_credentials.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace test {
+
+TEST(TracingTest, BEH_NotStarted) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_Test_Passport"));
+  const boost::filesystem::path kTracePath(*test_path / "trace.json");
+  EXPECT_FALSE(TracingEnabled());
+  EXPECT_FALSE(StopTracing(kTracePath));
+  EXPECT_FALSE(boost::filesystem::exists(kTracePath));
+}
+
+TEST(TracingTest, FUNC_WriteTrace) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_Test_Passport"));
+  const boost::filesystem::path kTracePath(*test_path / "trace.json");
+
+  StartTracing();
+  EXPECT_TRUE(TracingEnabled());
+  Anpmid anpmid;
+  Pmid pmid(anpmid);
+  Passport passport(CreateMaidAndSigner());
+  passport.AddKeyAndSigner(std::make_pair(pmid, anpmid));
+  PassportSession session(CreateUserCredentials());
+  Passport decrypted_passport(passport.Encrypt(session), session);
+  ASSERT_TRUE(StopTracing(kTracePath));
+  EXPECT_FALSE(TracingEnabled());
+
+  const std::string trace(ReadFile(kTracePath).string());
+  EXPECT_EQ(0U, trace.find("{\"traceEvents\":["));
+  EXPECT_NE(std::string::npos, trace.find("\"ph\":\"X\""));
+  EXPECT_NE(std::string::npos,
+            trace.find("{\"name\":\"KeyGeneration\",\"cat\":\"passport\",\"ph\":\"X\""));
+  EXPECT_NE(std::string::npos, trace.find("\"args\":{\"fob_type\":\"Pmid\"}"));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"ValidateToken\""));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"Passport::ToString\""));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"Passport::FromString\""));
+
+  // Stopping discards the events, so a second trace only holds what happened after it started.
+  StartTracing();
+  ASSERT_TRUE(StopTracing(kTracePath));
+  EXPECT_EQ(std::string::npos, ReadFile(kTracePath).string().find("\"name\""));
+}
+
+TEST(TracingTest, BEH_EventsFromOtherThreads) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_Test_Passport"));
+  const boost::filesystem::path kTracePath(*test_path / "trace.json");
+
+  // Events from a thread which has exited before tracing stops are kept; each thread's events are
+  // capped rather than growing without bound.
+  const int kEventCount(100000);
+  StartTracing();
+  std::thread worker([&] {
+    for (int i(0); i < kEventCount; ++i)
+      detail::ScopedTraceEvent event("Test::Worker");
+  });
+  worker.join();
+  {
+    detail::ScopedTraceEvent event("Test::Main");
+  }
+  ASSERT_TRUE(StopTracing(kTracePath));
+
+  const std::string trace(ReadFile(kTracePath).string());
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"Test::Main\""));
+  int worker_events(0);
+  for (auto pos(trace.find("\"name\":\"Test::Worker\"")); pos != std::string::npos;
+       pos = trace.find("\"name\":\"Test::Worker\"", pos + 1)) {
+    ++worker_events;
+  }
+  EXPECT_GT(worker_events, 0);
+  EXPECT_LT(worker_events, kEventCount);
+}
+
+}  // namespace test
+
+}  // namespace passport
+
+}  // namespace maidsafe
@@ -0,0 +1,52 @@
+/*  Copyright 2015 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_PASSPORT_TESTS_USER_CREDENTIALS_H_
+#define MAIDSAFE_PASSPORT_TESTS_USER_CREDENTIALS_H_
+
+#include <string>
+
+#include "maidsafe/common/make_unique.h"
+#include "maidsafe/common/utils.h"
+#include "maidsafe/common/authentication/user_credentials.h"
+
+namespace maidsafe {
+
+namespace passport {
+
+namespace test {
+
+// Doesn't depend on gtest, so is shared by the tests and the benchmarks.
+inline authentication::UserCredentials CreateUserCredentials() {
+  authentication::UserCredentials user_credentials;
+  user_credentials.keyword = maidsafe::make_unique<authentication::UserCredentials::Keyword>(
+      RandomAlphaNumericString((RandomUint32() % 100) + 1));
+  user_credentials.pin =
+      maidsafe::make_unique<authentication::UserCredentials::Pin>(std::to_string(RandomUint32()));
+  user_credentials.password = maidsafe::make_unique<authentication::UserCredentials::Password>(
+      RandomAlphaNumericString((RandomUint32() % 100) + 1));
+  return user_credentials;
+}
+
+}  // namespace test
+
+}  // namespace passport
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_PASSPORT_TESTS_USER_CREDENTIALS_H_